@@ -19,386 +19,8243 @@ Questions / Remarks:
 --*/
 
 #include <map>
-#include <set>
+#include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <deque>
+#include <memory>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <charconv>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using Vertex = std::string;
-using Edge = std::pair<std::string, std::string>;
-using AdjacencyList = std::map<Vertex, std::set<Vertex>>;
+using VertexId = uint32_t;
+using EdgeIndex = uint64_t;
+using Edge = std::pair<VertexId, VertexId>;
+using Weight = double;
 
-struct Graph
-{
-    std::vector<Edge> Edges;
-    std::set<Vertex> Vertices;
+constexpr VertexId InvalidVertex{ UINT32_MAX };
 
-    AdjacencyList Neighbors;
-    std::set<Vertex> Visited;
+//
+// Vertex dictionary. Interns vertex names into dense VertexIds using an
+// open-addressing (linear probing) hash table. The name bytes live in an
+// arena of fixed-size blocks so the string_views handed out by Name() stay
+// valid until Clear() is called, even as more names get interned.
+//
 
-    bool Dirty{ false };
+struct VertexDictionary
+{
+    static constexpr size_t BlockSize{ 64 * 1024 };
 
-    void Clear()
+    struct Entry
     {
-        Edges.clear();
-        Vertices.clear();
-        Neighbors.clear();
-        Visited.clear();
+        const char* Name;
+        uint32_t Length;
+        uint32_t Hash;
+    };
 
-        Dirty = false;
-    }
+    std::vector<Entry> Entries;   // Indexed by VertexId
+    std::vector<VertexId> Slots;  // InvalidVertex marks an empty slot
+    std::vector<std::unique_ptr<char[]>> Blocks;
+    size_t BlockUsed{ BlockSize };
 
-    void AddVertex(const std::string& name)
-    {
-        Vertices.insert(name);
+    VertexDictionary() = default;
 
-        Dirty = true;
-    }
+    //
+    // Entries point into Blocks, so a copy interns the names again, in id
+    // order, into blocks of its own. A move takes the blocks along.
+    //
 
-    void AddDirectedEdge(const std::string& first, const std::string& second)
+    VertexDictionary(const VertexDictionary& Other)
     {
-        AddVertex(first);
-        AddVertex(second);
-    
-        Edges.push_back(Edge(first, second));
+        *this = Other;
     }
 
-    void AddUndirectedEdge(const std::string& first, const std::string& second)
-    {
-        AddDirectedEdge(first, second);
-        AddDirectedEdge(second, first);
-    }
+    VertexDictionary(VertexDictionary&&) = default;
 
-    void BuildAdjacencyList()
+    VertexDictionary& operator=(const VertexDictionary& Other)
     {
-        //
-        // Walk the edges and construct the neighbors list.
-        //
-
-        for (Edge edge : Edges)
+        if (this != &Other)
         {
-            auto it = Neighbors.find(edge.first);
-
-            if (it != Neighbors.end())
-            {
-                //
-                // Add new neighbor.
-                //
+            Clear();
 
-                (*it).second.insert(edge.second);
-            }
-            else
+            for (VertexId v = 0; v < Other.Count(); ++v)
             {
-                //
-                // Add new vertex and neighbor.
-                //
-
-                Neighbors.insert(std::pair<Vertex, std::set<Vertex>>(edge.first, std::set<Vertex>({ edge.second })));
+                Intern(Other.Name(v));
             }
         }
 
+        return *this;
+    }
+
+    VertexDictionary& operator=(VertexDictionary&&) = default;
+
+    static uint32_t HashName(std::string_view Name)
+    {
         //
-        // Insert any lonely vertex.
+        // FNV-1a, folded to 32 bits.
         //
 
-        for (Vertex vertex : Vertices)
-        {
-            auto it = Neighbors.find(vertex);
+        uint64_t Hash{ 14695981039346656037ull };
 
-            if (it == Neighbors.end())
-            {
-                Neighbors.insert(std::pair<Vertex, std::set<Vertex>>(vertex, std::set<Vertex>()));
-            }
+        for (char c : Name)
+        {
+            Hash ^= static_cast<uint8_t>(c);
+            Hash *= 1099511628211ull;
         }
 
-        Dirty = false;
+        return static_cast<uint32_t>(Hash ^ (Hash >> 32));
     }
 
-    void PreWalk()
+    void Clear()
     {
-        Visited.clear();
+        Entries.clear();
+        Slots.clear();
+        Blocks.clear();
+        BlockUsed = BlockSize;
+    }
 
-        if (Dirty)
-        {
-            BuildAdjacencyList();
-        }
+    VertexId Count() const
+    {
+        return static_cast<VertexId>(Entries.size());
     }
 
-    typedef bool (*WalkCallback)(const Vertex& Name, [[maybe_unused]] int Distance, [[maybe_unused]] void* Context);
+    std::string_view Name(VertexId Id) const
+    {
+        const Entry& entry{ Entries[Id] };
+
+        return std::string_view(entry.Name, entry.Length);
+    }
 
-    bool DfsWalkWorker(Vertex Name, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, int Distance = 0, void* Context = nullptr)
+    VertexId Find(std::string_view Name) const
     {
-        if (Visited.find(Name) != Visited.end())
+        if (Slots.empty())
         {
-            return false;
+            return InvalidVertex;
         }
 
-        if (ComponentSize)
+        const uint32_t Hash{ HashName(Name) };
+        const size_t Mask{ Slots.size() - 1 };
+
+        for (size_t Slot = Hash & Mask; ; Slot = (Slot + 1) & Mask)
         {
-            ++(*ComponentSize);
-        }
+            const VertexId Id{ Slots[Slot] };
 
-        Visited.insert(Name);
+            if (Id == InvalidVertex)
+            {
+                return InvalidVertex;
+            }
 
-        if (Callback)
-        {
-            if (!Callback(Name, Distance, Context))
+            if (Matches(Entries[Id], Name, Hash))
             {
-                return true;
+                return Id;
             }
         }
+    }
 
-        auto it = Neighbors.find(Name);
+    VertexId Intern(std::string_view Name)
+    {
+        //
+        // Keep the load factor at or below 1/2 so probe sequences stay short.
+        //
 
-        if (it != Neighbors.end())
+        if ((Entries.size() + 1) * 2 > Slots.size())
         {
-            for (Vertex neighbor : (*it).second)
-            {
-                DfsWalkWorker(neighbor, ComponentSize, Callback, Distance + 1, Context);
-            }
+            Grow();
         }
 
-        return true;
-    }
+        const uint32_t Hash{ HashName(Name) };
+        const size_t Mask{ Slots.size() - 1 };
 
-    bool DfsWalk(Vertex Name, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, void* Context = nullptr)
-    {
-        PreWalk();
+        size_t Slot = Hash & Mask;
 
-        if (ComponentSize)
+        for (; Slots[Slot] != InvalidVertex; Slot = (Slot + 1) & Mask)
         {
-            (*ComponentSize) = 0;
+            if (Matches(Entries[Slots[Slot]], Name, Hash))
+            {
+                return Slots[Slot];
+            }
         }
 
-        return DfsWalkWorker(Name, ComponentSize, Callback, 0, Context);
+        const VertexId Id{ static_cast<VertexId>(Entries.size()) };
+
+        Entries.push_back(Entry{ Store(Name), static_cast<uint32_t>(Name.size()), Hash });
+        Slots[Slot] = Id;
+
+        return Id;
     }
 
-    bool BfsWalkWorker(Vertex Name, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, int Distance = 0, void* Context = nullptr)
+    void Permute(const std::vector<VertexId>& NewIds)
     {
-        if (Visited.find(Name) != Visited.end())
+        //
+        // Relabels every name, NewIds[v] being the new id of v. The names
+        // stay where they are in the arena; only the entries move.
+        //
+
+        std::vector<Entry> Moved(Entries.size());
+
+        for (VertexId Id = 0; Id < Entries.size(); ++Id)
         {
-            return false;
+            Moved[NewIds[Id]] = Entries[Id];
         }
 
-        const size_t Initial{ Visited.size() };
+        Entries = std::move(Moved);
 
-        using Entry = std::pair<Vertex, int>; // <Vertex, DistanceFromOrigin>
+        Rehash(Slots.size());
+    }
 
-        std::deque<Entry> Queue;
+private:
 
-        Visited.insert(Name);
-        Queue.push_back(Entry(Name, Distance));
+    static bool Matches(const Entry& entry, std::string_view Name, uint32_t Hash)
+    {
+        return (entry.Hash == Hash) &&
+               (entry.Length == Name.size()) &&
+               (memcmp(entry.Name, Name.data(), Name.size()) == 0);
+    }
 
-        while (Queue.size())
+    const char* Store(std::string_view Name)
+    {
+        if (Name.size() > BlockSize / 4)
         {
-            auto entry{ Queue.front() };
+            //
+            // Oversized names get a block of their own, slotted in before the
+            // current block so we keep filling the latter.
+            //
 
-            Queue.pop_front();
+            auto Block{ std::make_unique<char[]>(Name.size()) };
 
-            if (ComponentSize)
-            {
-                ++(*ComponentSize);
-            }
+            memcpy(Block.get(), Name.data(), Name.size());
 
-            if (Callback)
-            {
-                if (!Callback(entry.first, entry.second, Context))
-                {
-                    break;
-                }
-            }
+            const char* Stored{ Block.get() };
 
-            auto it = Neighbors.find(entry.first);
+            Blocks.insert(Blocks.empty() ? Blocks.end() : Blocks.end() - 1, std::move(Block));
 
-            if (it != Neighbors.end())
-            {
-                for (Vertex neighbor : (*it).second)
-                {
-                    if (Visited.find(neighbor) == Visited.end())
-                    {
-                        Visited.insert(neighbor);
-                        Queue.push_back(Entry(neighbor, entry.second + 1));
-                    }
-                }
-            }
+            return Stored;
         }
 
-        return (Visited.size() > Initial);
-    }
-
-    bool BfsWalk(Vertex Name, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, void* Context = nullptr)
-    {
-        PreWalk();
-
-        if (ComponentSize)
+        if (Blocks.empty() || (BlockUsed + Name.size() > BlockSize))
         {
-            (*ComponentSize) = 0;
+            Blocks.push_back(std::make_unique<char[]>(BlockSize));
+            BlockUsed = 0;
         }
 
-        return BfsWalkWorker(Name, ComponentSize, Callback, 0, Context);
+        char* Stored{ Blocks.back().get() + BlockUsed };
+
+        memcpy(Stored, Name.data(), Name.size());
+        BlockUsed += Name.size();
+
+        return Stored;
     }
 
-    unsigned int ConnectedComponents(unsigned int& SmallestComponent, unsigned int& LargestComponent)
+    void Grow()
     {
-        PreWalk();
+        Rehash(Slots.empty() ? 16 : Slots.size() * 2);
+    }
 
-        unsigned int componentCount{ 0 };
+    void Rehash(size_t Capacity)
+    {
+        const size_t Mask{ Capacity - 1 };
 
-        LargestComponent = 0;
-        SmallestComponent = UINT_MAX;
+        Slots.assign(Capacity, InvalidVertex);
 
-        for (Vertex vertex : Vertices)
+        for (VertexId Id = 0; Id < Entries.size(); ++Id)
         {
-            unsigned int componentSize{ 0 };
+            size_t Slot = Entries[Id].Hash & Mask;
 
-            if (DfsWalkWorker(vertex, &componentSize))
+            while (Slots[Slot] != InvalidVertex)
             {
-                ++componentCount;
-
-                LargestComponent = std::max(LargestComponent, componentSize);
-                SmallestComponent = std::min(SmallestComponent, componentSize);
+                Slot = (Slot + 1) & Mask;
             }
+
+            Slots[Slot] = Id;
         }
+    }
+};
+
+//
+// Visited tracking over dense ids. Both flavors expose the same interface:
+// Reset() before a traversal, then Test(), Set() and TestAndSet(), the last
+// returning whether the vertex had already been visited.
+//
+// VisitedBitmap is one bit per vertex and suits one-off traversals that
+// touch most of the graph anyway.
+//
+// VisitedEpochs stamps each vertex with the epoch of the traversal that
+// visited it. Reset() just bumps the epoch, so repeated queries that only
+// explore a small part of the graph never pay for clearing the array.
+//
+
+struct VisitedBitmap
+{
+    std::vector<uint64_t> Bits;
 
-        return componentCount;
+    void Reset(VertexId Count)
+    {
+        Bits.assign((static_cast<size_t>(Count) + 63) / 64, 0);
     }
 
-    struct DistanceContext
+    bool Test(VertexId Id) const
     {
-        const Vertex& To;
-        int Distance;
-    };
+        return (Bits[Id >> 6] >> (Id & 63)) & 1;
+    }
 
-    static bool DistanceCallback(const Vertex& Name, [[maybe_unused]] int Distance, [[maybe_unused]] void* Ctx)
+    void Set(VertexId Id)
     {
-        DistanceContext* Context{ static_cast<DistanceContext*>(Ctx) };
+        Bits[Id >> 6] |= (1ull << (Id & 63));
+    }
 
-        if (Name == Context->To)
-        {
-            Context->Distance = Distance;
+    bool TestAndSet(VertexId Id)
+    {
+        const uint64_t Mask{ 1ull << (Id & 63) };
+        uint64_t& Word{ Bits[Id >> 6] };
 
-            return false;
-        }
+        const bool Seen{ (Word & Mask) != 0 };
+
+        Word |= Mask;
 
-        return true; // Continue walk
+        return Seen;
     }
+};
+
+struct VisitedEpochs
+{
+    std::vector<uint32_t> Stamps;
+    uint32_t Epoch{ 0 };
 
-    int ShortestDistance(const Vertex& From, const Vertex& To)
+    void Reset(VertexId Count)
     {
-        if (From == To)
+        if (Stamps.size() != Count)
         {
-            return 0;
+            Stamps.resize(Count, 0);
+        }
+
+        if (++Epoch == 0)
+        {
+            //
+            // The epoch wrapped around: stale stamps could now alias the
+            // new epoch, so pay for one real clear.
+            //
+
+            std::fill(Stamps.begin(), Stamps.end(), 0);
+            Epoch = 1;
         }
+    }
+
+    bool Test(VertexId Id) const
+    {
+        return Stamps[Id] == Epoch;
+    }
+
+    void Set(VertexId Id)
+    {
+        Stamps[Id] = Epoch;
+    }
 
-        DistanceContext Context{ To, -1 };
+    bool TestAndSet(VertexId Id)
+    {
+        const bool Seen{ Stamps[Id] == Epoch };
 
-        BfsWalk(From, nullptr, DistanceCallback, &Context);
+        Stamps[Id] = Epoch;
 
-        return Context.Distance; // -1 when no path was found
+        return Seen;
     }
 };
 
-#include <iostream>
+//
+// Worker count for the parallel algorithms: the requested count, or one
+// per hardware thread when zero.
+//
 
-void DumpAdjacencyList(Graph& g)
+inline unsigned int WorkerCount(unsigned int Requested)
 {
-    g.PreWalk();
-
-    if (g.Neighbors.empty())
+    if (Requested)
     {
-        std::cout << "The adjacency list is empty.\n";
+        return Requested;
     }
 
-    for (auto vertex : g.Neighbors)
-    {
-        bool first{ true };
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
 
-        std::cout << vertex.first << ": [";
+//
+// Runs Body(Begin, End) over [0, Count) on WorkerCount(ThreadCount)
+// threads, which claim ChunkSize-sized ranges from a shared atomic cursor
+// so uneven chunks balance out. The calling thread is one of the workers.
+//
+
+template <typename Body>
+void ParallelFor(size_t Count, unsigned int ThreadCount, Body&& body, size_t ChunkSize = 1024)
+{
+    std::atomic<size_t> Cursor{ 0 };
 
-        for (Vertex neighbor : vertex.second)
+    auto Worker = [&]()
+    {
+        for (;;)
         {
-            if (!first)
-            {
-                std::cout << ", ";
-            }
-            else
+            const size_t Begin{ Cursor.fetch_add(ChunkSize, std::memory_order_relaxed) };
+
+            if (Begin >= Count)
             {
-                first = false;
+                break;
             }
 
-            std::cout << neighbor;
+            body(Begin, std::min(Begin + ChunkSize, Count));
         }
+    };
 
-        std::cout << "]\n";
+    const unsigned int Workers{ static_cast<unsigned int>(std::min<size_t>(WorkerCount(ThreadCount), (Count + ChunkSize - 1) / ChunkSize)) };
+
+    std::vector<std::thread> Threads;
+
+    for (unsigned int t = 1; t < Workers; ++t)
+    {
+        Threads.emplace_back(Worker);
     }
 
-    std::cout << "\n";
+    Worker();
+
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
 }
 
-bool PrintVertex(const Vertex& Name, [[maybe_unused]] int Distance, [[maybe_unused]] void* Context)
+//
+// Sorts [First, Last) on WorkerCount(ThreadCount) threads: each thread
+// sorts one slice, then neighboring runs are merged pairwise, each round
+// of merges in parallel, until a single run is left.
+//
+
+template <typename Iterator, typename Less>
+void ParallelSort(Iterator First, Iterator Last, Less&& less, unsigned int ThreadCount = 0)
 {
-    std::cout << Name << "\n";
+    const size_t Count{ static_cast<size_t>(Last - First) };
+    const size_t Slices{ std::min<size_t>(WorkerCount(ThreadCount), std::max<size_t>(Count / 65536, 1)) };
+    const size_t Width{ (Count + Slices - 1) / Slices };
 
-    return true; // Continue walk
+    auto At = [&](size_t Index)
+    {
+        return First + static_cast<ptrdiff_t>(std::min(Index, Count));
+    };
+
+    ParallelFor(Slices, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (size_t s = Begin; s < End; ++s)
+        {
+            std::sort(At(s * Width), At((s + 1) * Width), less);
+        }
+    }, 1);
+
+    for (size_t Run = Width; Run < Count; Run *= 2)
+    {
+        ParallelFor((Count + 2 * Run - 1) / (2 * Run), ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t m = Begin; m < End; ++m)
+            {
+                std::inplace_merge(At(2 * m * Run), At((2 * m + 1) * Run), At((2 * m + 2) * Run), less);
+            }
+        }, 1);
+    }
 }
 
-int main()
+//
+// The neighbors of one vertex, as returned by the Neighbors() method that
+// every adjacency type provides. The bulk traversals below only go through
+// Neighbors(), Degree(), VertexCount() and EdgeCount(), so they run
+// unchanged on any of them.
+//
+
+struct NeighborRange
 {
-    std::cout << "Hello Graphs!\n\n";
+    const VertexId* First;
+    const VertexId* Last;
 
-    Graph g;
+    const VertexId* begin() const
+    {
+        return First;
+    }
 
-    g.AddUndirectedEdge("1", "2");
-    g.AddVertex("3");
-    g.AddUndirectedEdge("4", "6");
-    g.AddUndirectedEdge("5", "6");
-    g.AddUndirectedEdge("7", "6");
-    g.AddUndirectedEdge("8", "6");
+    const VertexId* end() const
+    {
+        return Last;
+    }
 
-    DumpAdjacencyList(g);
+    size_t size() const
+    {
+        return static_cast<size_t>(Last - First);
+    }
+};
 
-    unsigned int LargestComponent;
-    unsigned int SmallestComponent;
+//
+// Compressed sparse row adjacency: the neighbors of vertex v are
+// Targets[Offsets[v]] .. Targets[Offsets[v + 1] - 1], sorted by id and
+// free of duplicates. Weighted graphs carry a Weights array parallel to
+// Targets; it stays empty when every edge weighs 1.
+//
 
-    unsigned int ConnectedComponents{ g.ConnectedComponents(SmallestComponent, LargestComponent) };
- 
-    if (ConnectedComponents)
+struct CsrAdjacency
+{
+    std::vector<EdgeIndex> Offsets;
+    std::vector<VertexId> Targets;
+    std::vector<Weight> Weights;
+
+    void Clear()
     {
-        std::cout << "Connected components: " << ConnectedComponents << "\n";
-        std::cout << "Smallest component: " << SmallestComponent << "\n";
-        std::cout << "Largest component: " << LargestComponent << "\n\n";
+        Offsets.clear();
+        Targets.clear();
+        Weights.clear();
     }
 
-    g.Clear();
+    VertexId VertexCount() const
+    {
+        return Offsets.empty() ? 0 : static_cast<VertexId>(Offsets.size() - 1);
+    }
 
-    g.AddUndirectedEdge("w", "x");
-    g.AddUndirectedEdge("x", "y");
-    g.AddUndirectedEdge("z", "y");
-    g.AddUndirectedEdge("u", "v");
-    g.AddUndirectedEdge("z", "u");
-    g.AddUndirectedEdge("w", "v");
-    g.AddUndirectedEdge("w", "y");
+    EdgeIndex EdgeCount() const
+    {
+        return Targets.size();
+    }
 
-    DumpAdjacencyList(g);
+    EdgeIndex Degree(VertexId Id) const
+    {
+        return Offsets[Id + 1] - Offsets[Id];
+    }
 
-    ConnectedComponents = g.ConnectedComponents(SmallestComponent, LargestComponent);
- 
-    if (ConnectedComponents)
+    const VertexId* Begin(VertexId Id) const
     {
-        std::cout << "Connected components: " << ConnectedComponents << "\n";
-        std::cout << "Smallest component: " << SmallestComponent << "\n";
-        std::cout << "Largest component: " << LargestComponent << "\n\n";
+        return Targets.data() + Offsets[Id];
     }
 
-    std::cout << "DFS walk:\n\n";
+    const VertexId* End(VertexId Id) const
+    {
+        return Targets.data() + Offsets[Id + 1];
+    }
 
-    g.DfsWalk("w", nullptr, PrintVertex);
+    NeighborRange Neighbors(VertexId Id) const
+    {
+        return { Begin(Id), End(Id) };
+    }
 
-    std::cout << "\nBFS walk:\n\n";
+    Weight WeightAt(EdgeIndex Index) const
+    {
+        return Weights.empty() ? 1 : Weights[Index];
+    }
 
-    g.BfsWalk("w", nullptr, PrintVertex);
+    void Build(VertexId Count, const std::vector<Edge>& Edges, bool Transpose = false, const std::vector<Weight>& EdgeWeights = {}, unsigned int ThreadCount = 0)
+    {
+        constexpr size_t EdgeChunk{ 64 * 1024 };
 
-    std::cout << "\nShortest distance from 'w' to 'z' : " << g.ShortestDistance("w", "z") << "\n";
+        const bool Weighted{ !EdgeWeights.empty() };
+
+        auto Source = [&Edges, Transpose](size_t e)
+        {
+            return Transpose ? Edges[e].second : Edges[e].first;
+        };
+
+        //
+        // Parallel counting sort of the edges by source (by target when
+        // building the transpose): count the degrees with atomic increments,
+        // turn them into offsets with a prefix sum, then scatter the other
+        // endpoint, each edge claiming its slot with an atomic cursor.
+        //
+
+        Offsets.assign(static_cast<size_t>(Count) + 1, 0);
+
+        ParallelFor(Edges.size(), ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t e = Begin; e < End; ++e)
+            {
+                std::atomic_ref<EdgeIndex>(Offsets[Source(e) + 1]).fetch_add(1, std::memory_order_relaxed);
+            }
+        }, EdgeChunk);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Offsets[v + 1] += Offsets[v];
+        }
+
+        std::vector<VertexId> Scattered(Edges.size());
+        std::vector<Weight> ScatteredWeights(Weighted ? Edges.size() : 0);
+        std::vector<EdgeIndex> Cursor(Offsets.begin(), Offsets.end() - 1);
+
+        ParallelFor(Edges.size(), ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t e = Begin; e < End; ++e)
+            {
+                const EdgeIndex Slot{ std::atomic_ref<EdgeIndex>(Cursor[Source(e)]).fetch_add(1, std::memory_order_relaxed) };
+
+                Scattered[Slot] = Transpose ? Edges[e].first : Edges[e].second;
+
+                if (Weighted)
+                {
+                    ScatteredWeights[Slot] = EdgeWeights[e];
+                }
+            }
+        }, EdgeChunk);
+
+        //
+        // Sort each neighbor list and squeeze out the parallel edges, in
+        // parallel over the vertices. Of several parallel weighted edges,
+        // the lightest one is kept. A second prefix sum over the surviving
+        // degrees then places every list in the final arrays.
+        //
+
+        std::vector<EdgeIndex> Kept(static_cast<size_t>(Count) + 1, 0);
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            std::vector<std::pair<VertexId, Weight>> Scratch;
+
+            for (size_t v = Begin; v < End; ++v)
+            {
+                const EdgeIndex First{ Offsets[v] };
+                const EdgeIndex Last{ Offsets[v + 1] };
+
+                EdgeIndex Write{ First };
+
+                if (Weighted)
+                {
+                    Scratch.clear();
+
+                    for (EdgeIndex e = First; e < Last; ++e)
+                    {
+                        Scratch.emplace_back(Scattered[e], ScatteredWeights[e]);
+                    }
+
+                    std::sort(Scratch.begin(), Scratch.end());
+
+                    for (size_t i = 0; i < Scratch.size(); ++i)
+                    {
+                        if ((i == 0) || (Scratch[i].first != Scratch[i - 1].first))
+                        {
+                            Scattered[Write] = Scratch[i].first;
+                            ScatteredWeights[Write] = Scratch[i].second;
+                            ++Write;
+                        }
+                    }
+                }
+                else
+                {
+                    auto ListBegin{ Scattered.begin() + static_cast<ptrdiff_t>(First) };
+                    auto ListEnd{ Scattered.begin() + static_cast<ptrdiff_t>(Last) };
+
+                    std::sort(ListBegin, ListEnd);
+
+                    Write = First + static_cast<EdgeIndex>(std::unique(ListBegin, ListEnd) - ListBegin);
+                }
+
+                Kept[v + 1] = Write - First;
+            }
+        }, 256);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Kept[v + 1] += Kept[v];
+        }
+
+        Targets.resize(Kept[Count]);
+        Weights.resize(Weighted ? Kept[Count] : 0);
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t v = Begin; v < End; ++v)
+            {
+                const EdgeIndex Length{ Kept[v + 1] - Kept[v] };
+
+                std::copy_n(Scattered.begin() + static_cast<ptrdiff_t>(Offsets[v]), Length, Targets.begin() + static_cast<ptrdiff_t>(Kept[v]));
+
+                if (Weighted)
+                {
+                    std::copy_n(ScatteredWeights.begin() + static_cast<ptrdiff_t>(Offsets[v]), Length, Weights.begin() + static_cast<ptrdiff_t>(Kept[v]));
+                }
+            }
+        }, 256);
+
+        Offsets = std::move(Kept);
+    }
+};
+
+//
+// Edges added since a CsrAdjacency was built, kept per source vertex until
+// they are merged in. Insert() applies what it can to the CSR in place (a
+// parallel edge only lowers the weight of the existing one) and logs the
+// rest, so the two together always hold the current adjacency without
+// duplicates. ForEachEdge() walks both.
+//
+
+struct DeltaAdjacency
+{
+    std::unordered_map<VertexId, std::vector<std::pair<VertexId, Weight>>> Lists;
+
+    EdgeIndex Count{ 0 };
+    bool Weighted{ false };
+
+    void Clear()
+    {
+        Lists.clear();
+        Count = 0;
+        Weighted = false;
+    }
+
+    bool Empty() const
+    {
+        return Count == 0;
+    }
+
+    void Insert(CsrAdjacency& Base, VertexId From, VertexId To, Weight Cost)
+    {
+        if (From < Base.VertexCount())
+        {
+            const VertexId* First{ Base.Begin(From) };
+            const VertexId* Last{ Base.End(From) };
+            const VertexId* Found{ std::lower_bound(First, Last, To) };
+
+            if ((Found != Last) && (*Found == To))
+            {
+                if (Cost < Base.WeightAt(static_cast<EdgeIndex>(Found - Base.Targets.data())))
+                {
+                    if (Base.Weights.empty())
+                    {
+                        Base.Weights.assign(Base.Targets.size(), 1);
+                    }
+
+                    Base.Weights[static_cast<size_t>(Found - Base.Targets.data())] = Cost;
+                }
+
+                return;
+            }
+        }
+
+        std::vector<std::pair<VertexId, Weight>>& List{ Lists[From] };
+
+        for (std::pair<VertexId, Weight>& Entry : List)
+        {
+            if (Entry.first == To)
+            {
+                Entry.second = std::min(Entry.second, Cost);
+
+                return;
+            }
+        }
+
+        List.emplace_back(To, Cost);
+
+        Weighted |= (Cost != 1);
+        ++Count;
+    }
+
+    void MergeInto(CsrAdjacency& Base, VertexId VertexCount, unsigned int ThreadCount = 0)
+    {
+        //
+        // Linear merge of the sorted base lists with the sorted delta lists,
+        // in parallel over the vertices. Also extends the CSR to vertices
+        // added since it was built.
+        //
+
+        for (auto& Entry : Lists)
+        {
+            std::sort(Entry.second.begin(), Entry.second.end());
+        }
+
+        const VertexId BaseCount{ Base.VertexCount() };
+        const bool KeepWeights{ Weighted || !Base.Weights.empty() };
+
+        std::vector<EdgeIndex> Offsets(static_cast<size_t>(VertexCount) + 1, 0);
+
+        for (VertexId v = 0; v < VertexCount; ++v)
+        {
+            const auto Found{ Lists.find(v) };
+
+            Offsets[v + 1] = Offsets[v] + ((v < BaseCount) ? Base.Degree(v) : 0) + ((Found != Lists.end()) ? Found->second.size() : 0);
+        }
+
+        std::vector<VertexId> Targets(Offsets[VertexCount]);
+        std::vector<Weight> Weights(KeepWeights ? Targets.size() : 0);
+
+        ParallelFor(VertexCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t v = Begin; v < End; ++v)
+            {
+                const auto Found{ Lists.find(static_cast<VertexId>(v)) };
+
+                EdgeIndex b{ (v < BaseCount) ? Base.Offsets[v] : 0 };
+                const EdgeIndex BaseEnd{ (v < BaseCount) ? Base.Offsets[v + 1] : 0 };
+
+                size_t d{ 0 };
+                const size_t DeltaEnd{ (Found != Lists.end()) ? Found->second.size() : 0 };
+
+                for (EdgeIndex Write = Offsets[v]; Write < Offsets[v + 1]; ++Write)
+                {
+                    const bool FromBase{ (d == DeltaEnd) || ((b < BaseEnd) && (Base.Targets[b] < Found->second[d].first)) };
+
+                    if (FromBase)
+                    {
+                        Targets[Write] = Base.Targets[b];
+
+                        if (KeepWeights)
+                        {
+                            Weights[Write] = Base.WeightAt(b);
+                        }
+
+                        ++b;
+                    }
+                    else
+                    {
+                        Targets[Write] = Found->second[d].first;
+
+                        if (KeepWeights)
+                        {
+                            Weights[Write] = Found->second[d].second;
+                        }
+
+                        ++d;
+                    }
+                }
+            }
+        }, 256);
+
+        Base.Offsets = std::move(Offsets);
+        Base.Targets = std::move(Targets);
+        Base.Weights = std::move(Weights);
+
+        Clear();
+    }
+};
+
+//
+// Calls Visit(Neighbor, Weight) for every out-edge of u, across a CSR and
+// the delta logged against it.
+//
+
+template <typename Visit>
+inline void ForEachEdge(const CsrAdjacency& Base, const DeltaAdjacency& Delta, VertexId u, Visit&& visit)
+{
+    if (u < Base.VertexCount())
+    {
+        for (EdgeIndex e = Base.Offsets[u]; e < Base.Offsets[u + 1]; ++e)
+        {
+            visit(Base.Targets[e], Base.WeightAt(e));
+        }
+    }
+
+    if (!Delta.Empty())
+    {
+        const auto Found{ Delta.Lists.find(u) };
+
+        if (Found != Delta.Lists.end())
+        {
+            for (const auto& Entry : Found->second)
+            {
+                visit(Entry.first, Entry.second);
+            }
+        }
+    }
+}
+
+//
+// Adjacency that takes batches of edge insertions and deletions without a
+// rebuild. Every vertex owns a block of Targets with some slack at its end:
+// the neighbors of v are Targets[Start[v]] .. Targets[Start[v] + Length[v]
+// - 1], sorted and free of duplicates, and the block has room for
+// Capacity[v] of them. The blocks start out end to end in vertex order, so
+// a scan reads memory almost like the CSR it came from. A block that runs
+// out of room moves to the end of the array with twice as much; once the
+// holes it leaves behind (or the slack freed by deletions) take up too
+// much of the array, Repack() lays the blocks out end to end again.
+//
+// Unweighted: it feeds the traversals, not the shortest paths.
+//
+
+struct DynamicAdjacency
+{
+    std::vector<EdgeIndex> Start;
+    std::vector<VertexId> Length;
+    std::vector<VertexId> Capacity;
+    std::vector<VertexId> Targets;
+
+    //
+    // Live counts the edges, Reserved the sum of the capacities; the rest
+    // of Targets is holes left by blocks that moved.
+    //
+
+    EdgeIndex Live{ 0 };
+    EdgeIndex Reserved{ 0 };
+
+    void Clear()
+    {
+        Start.clear();
+        Length.clear();
+        Capacity.clear();
+        Targets.clear();
+
+        Live = 0;
+        Reserved = 0;
+    }
+
+    VertexId VertexCount() const
+    {
+        return static_cast<VertexId>(Length.size());
+    }
+
+    EdgeIndex EdgeCount() const
+    {
+        return Live;
+    }
+
+    EdgeIndex Degree(VertexId Id) const
+    {
+        return Length[Id];
+    }
+
+    NeighborRange Neighbors(VertexId Id) const
+    {
+        const VertexId* First{ Targets.data() + Start[Id] };
+
+        return { First, First + Length[Id] };
+    }
+
+    static VertexId SlackFor(EdgeIndex Degree)
+    {
+        //
+        // A quarter more room than needed, and at least a few slots, except
+        // for isolated vertices which get none until their first edge.
+        //
+
+        constexpr EdgeIndex MinimumCapacity{ 4 };
+        constexpr EdgeIndex MaximumCapacity{ std::numeric_limits<VertexId>::max() };
+
+        if (Degree == 0)
+        {
+            return 0;
+        }
+
+        return static_cast<VertexId>(std::min(std::max(Degree + Degree / 4, MinimumCapacity), MaximumCapacity));
+    }
+
+    void Build(const CsrAdjacency& Base, unsigned int ThreadCount = 0)
+    {
+        const VertexId Count{ Base.VertexCount() };
+
+        Length.resize(Count);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Length[v] = static_cast<VertexId>(Base.Degree(v));
+        }
+
+        Live = Base.EdgeCount();
+
+        Layout([&Base](VertexId v) { return Base.Begin(v); }, ThreadCount);
+    }
+
+    void Repack(unsigned int ThreadCount = 0)
+    {
+        const std::vector<VertexId> OldTargets{ std::move(Targets) };
+        const std::vector<EdgeIndex> OldStart{ std::move(Start) };
+
+        Layout([&](VertexId v) { return OldTargets.data() + OldStart[v]; }, ThreadCount);
+    }
+
+    void Resize(VertexId Count)
+    {
+        //
+        // New vertices start out isolated, with an empty block.
+        //
+
+        if (Count > VertexCount())
+        {
+            Start.resize(Count, Targets.size());
+            Length.resize(Count, 0);
+            Capacity.resize(Count, 0);
+        }
+    }
+
+    EdgeIndex InsertEdges(std::vector<Edge> Batch, unsigned int ThreadCount = 0)
+    {
+        //
+        // Adds the edges of the batch that are not there yet, growing the
+        // vertex range to cover their endpoints, and returns how many were
+        // added.
+        //
+
+        constexpr EdgeIndex Stay{ std::numeric_limits<EdgeIndex>::max() };
+
+        Normalize(Batch);
+
+        if (Batch.empty())
+        {
+            return 0;
+        }
+
+        VertexId Highest{ 0 };
+
+        for (const Edge& edge : Batch)
+        {
+            Highest = std::max({ Highest, edge.first, edge.second });
+        }
+
+        Resize(Highest + 1);
+
+        const std::vector<size_t> Runs{ SourceRuns(Batch) };
+        const size_t RunCount{ Runs.size() - 1 };
+
+        //
+        // Squeeze the edges that already exist out of each run, in parallel
+        // over the sources.
+        //
+
+        std::vector<VertexId> Fresh(RunCount);
+
+        ParallelFor(RunCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t r = Begin; r < End; ++r)
+            {
+                const NeighborRange Present{ Neighbors(Batch[Runs[r]].first) };
+                const VertexId* Cursor{ Present.begin() };
+
+                size_t Write{ Runs[r] };
+
+                for (size_t i = Runs[r]; i < Runs[r + 1]; ++i)
+                {
+                    Cursor = std::lower_bound(Cursor, Present.end(), Batch[i].second);
+
+                    if ((Cursor == Present.end()) || (*Cursor != Batch[i].second))
+                    {
+                        Batch[Write++] = Batch[i];
+                    }
+                }
+
+                Fresh[r] = static_cast<VertexId>(Write - Runs[r]);
+            }
+        }, 64);
+
+        //
+        // Serially hand a new block at the end of the array to every vertex
+        // that outgrows its own.
+        //
+
+        std::vector<EdgeIndex> Moved(RunCount, Stay);
+
+        EdgeIndex Tail{ Targets.size() };
+
+        for (size_t r = 0; r < RunCount; ++r)
+        {
+            const VertexId u{ Batch[Runs[r]].first };
+            const EdgeIndex Needed{ static_cast<EdgeIndex>(Length[u]) + Fresh[r] };
+
+            if (Needed > Capacity[u])
+            {
+                const VertexId Grown{ std::max(SlackFor(Needed), static_cast<VertexId>(std::min<EdgeIndex>(2ull * Capacity[u], std::numeric_limits<VertexId>::max()))) };
+
+                Reserved += Grown - Capacity[u];
+                Capacity[u] = Grown;
+                Moved[r] = Tail;
+                Tail += Grown;
+            }
+
+            Live += Fresh[r];
+        }
+
+        Targets.resize(Tail);
+
+        //
+        // Merge each run into its block from the back, which works in place
+        // as well as into a moved block, in parallel over the sources.
+        //
+
+        ParallelFor(RunCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t r = Begin; r < End; ++r)
+            {
+                const VertexId u{ Batch[Runs[r]].first };
+                const EdgeIndex Destination{ (Moved[r] == Stay) ? Start[u] : Moved[r] };
+
+                EdgeIndex Old{ Length[u] };
+                size_t Added{ Fresh[r] };
+                EdgeIndex Write{ Old + Added };
+
+                while (Added)
+                {
+                    const VertexId Candidate{ Batch[Runs[r] + Added - 1].second };
+
+                    if (Old && (Targets[Start[u] + Old - 1] > Candidate))
+                    {
+                        Targets[Destination + --Write] = Targets[Start[u] + --Old];
+                    }
+                    else
+                    {
+                        Targets[Destination + --Write] = Candidate;
+                        --Added;
+                    }
+                }
+
+                if (Destination != Start[u])
+                {
+                    std::copy_n(Targets.begin() + static_cast<ptrdiff_t>(Start[u]), Old, Targets.begin() + static_cast<ptrdiff_t>(Destination));
+                }
+
+                Start[u] = Destination;
+                Length[u] += Fresh[r];
+            }
+        }, 64);
+
+        RepackIfSparse(ThreadCount);
+
+        return std::accumulate(Fresh.begin(), Fresh.end(), EdgeIndex{ 0 });
+    }
+
+    EdgeIndex DeleteEdges(std::vector<Edge> Batch, unsigned int ThreadCount = 0)
+    {
+        //
+        // Removes the edges of the batch that exist and returns how many
+        // were removed. Blocks shrink in place, keeping the freed slots as
+        // slack for later insertions.
+        //
+
+        Normalize(Batch);
+
+        const VertexId Count{ VertexCount() };
+
+        Batch.erase(std::lower_bound(Batch.begin(), Batch.end(), Edge(Count, 0)), Batch.end());
+
+        if (Batch.empty())
+        {
+            return 0;
+        }
+
+        const std::vector<size_t> Runs{ SourceRuns(Batch) };
+        const size_t RunCount{ Runs.size() - 1 };
+
+        std::vector<VertexId> Removed(RunCount);
+
+        ParallelFor(RunCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t r = Begin; r < End; ++r)
+            {
+                const VertexId u{ Batch[Runs[r]].first };
+                VertexId* Block{ Targets.data() + Start[u] };
+
+                size_t Next{ Runs[r] };
+                VertexId Write{ 0 };
+
+                for (VertexId Read = 0; Read < Length[u]; ++Read)
+                {
+                    while ((Next < Runs[r + 1]) && (Batch[Next].second < Block[Read]))
+                    {
+                        ++Next;
+                    }
+
+                    if ((Next == Runs[r + 1]) || (Batch[Next].second != Block[Read]))
+                    {
+                        Block[Write++] = Block[Read];
+                    }
+                }
+
+                Removed[r] = Length[u] - Write;
+                Length[u] = Write;
+            }
+        }, 64);
+
+        const EdgeIndex Total{ std::accumulate(Removed.begin(), Removed.end(), EdgeIndex{ 0 }) };
+
+        Live -= Total;
+
+        RepackIfSparse(ThreadCount);
+
+        return Total;
+    }
+
+    EdgeIndex DeleteVertices(const std::vector<VertexId>& Victims, unsigned int ThreadCount = 0)
+    {
+        //
+        // Removes every edge into or out of the given vertices and returns
+        // how many were removed. The ids stay allocated, as isolated
+        // vertices. One parallel pass over all the blocks.
+        //
+
+        const VertexId Count{ VertexCount() };
+
+        VisitedBitmap Doomed;
+
+        Doomed.Reset(Count);
+
+        for (VertexId Id : Victims)
+        {
+            if (Id < Count)
+            {
+                Doomed.Set(Id);
+            }
+        }
+
+        std::atomic<EdgeIndex> Total{ 0 };
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            EdgeIndex Mine{ 0 };
+
+            for (size_t u = Begin; u < End; ++u)
+            {
+                VertexId Write{ 0 };
+
+                if (!Doomed.Test(static_cast<VertexId>(u)))
+                {
+                    VertexId* Block{ Targets.data() + Start[u] };
+
+                    for (VertexId Read = 0; Read < Length[u]; ++Read)
+                    {
+                        if (!Doomed.Test(Block[Read]))
+                        {
+                            Block[Write++] = Block[Read];
+                        }
+                    }
+                }
+
+                Mine += Length[u] - Write;
+                Length[u] = Write;
+            }
+
+            Total.fetch_add(Mine, std::memory_order_relaxed);
+        }, 256);
+
+        Live -= Total.load();
+
+        RepackIfSparse(ThreadCount);
+
+        return Total.load();
+    }
+
+private:
+
+    template <typename Source>
+    void Layout(Source&& source, unsigned int ThreadCount)
+    {
+        const VertexId Count{ VertexCount() };
+
+        Start.resize(Count);
+        Capacity.resize(Count);
+
+        Reserved = 0;
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Start[v] = Reserved;
+            Capacity[v] = SlackFor(Length[v]);
+            Reserved += Capacity[v];
+        }
+
+        Targets.clear();
+        Targets.resize(Reserved);
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t v = Begin; v < End; ++v)
+            {
+                std::copy_n(source(static_cast<VertexId>(v)), Length[v], Targets.begin() + static_cast<ptrdiff_t>(Start[v]));
+            }
+        }, 256);
+    }
+
+    void RepackIfSparse(unsigned int ThreadCount)
+    {
+        //
+        // Holes over half of the array, or live edges under a quarter of
+        // the reserved room: either way scans would be wading through
+        // empty slots.
+        //
+
+        const EdgeIndex Holes{ Targets.size() - Reserved };
+
+        if ((Holes > Targets.size() / 2) || (Live < Reserved / 4))
+        {
+            Repack(ThreadCount);
+        }
+    }
+
+    static void Normalize(std::vector<Edge>& Batch)
+    {
+        std::sort(Batch.begin(), Batch.end());
+
+        Batch.erase(std::unique(Batch.begin(), Batch.end()), Batch.end());
+    }
+
+    static std::vector<size_t> SourceRuns(const std::vector<Edge>& Batch)
+    {
+        //
+        // Where each run of edges with the same source starts in a sorted
+        // batch, followed by the size of the batch.
+        //
+
+        std::vector<size_t> Runs;
+
+        for (size_t i = 0; i < Batch.size(); ++i)
+        {
+            if ((i == 0) || (Batch[i].first != Batch[i - 1].first))
+            {
+                Runs.push_back(i);
+            }
+        }
+
+        Runs.push_back(Batch.size());
+
+        return Runs;
+    }
+};
+
+//
+// CSR with the neighbor lists gap encoded into byte-aligned varints, for
+// graphs whose 32-bit targets would not fit in memory. The list of u takes
+// Bytes[Offsets[u]] .. Bytes[Offsets[u + 1] - 1]: its length, then the
+// first neighbor as a zigzag-encoded difference from u, then the distance
+// from each neighbor to the next, minus one since lists are sorted and
+// free of duplicates. Each varint carries 7 bits per byte, low bits first,
+// the high bit flagging a continuation. Neighbors() decodes on the fly as
+// the traversal iterates, so locality-preserving ids (see the orderings
+// below) directly mean fewer bytes. It can be built from a CsrAdjacency or
+// straight from a sorted edge list, without the 32-bit targets ever being
+// laid out.
+//
+// Unweighted, like DynamicAdjacency.
+//
+
+struct CompressedAdjacency
+{
+    std::vector<EdgeIndex> Offsets;
+    std::vector<uint8_t> Bytes;
+
+    EdgeIndex Edges{ 0 };
+
+    struct Iterator
+    {
+        const uint8_t* Cursor;
+        EdgeIndex Remaining;
+        VertexId Current;
+
+        VertexId operator*() const
+        {
+            return Current;
+        }
+
+        Iterator& operator++()
+        {
+            if (--Remaining)
+            {
+                Current += static_cast<VertexId>(Decode(Cursor) + 1);
+            }
+
+            return *this;
+        }
+
+        bool operator!=(const Iterator& Other) const
+        {
+            return Remaining != Other.Remaining;
+        }
+    };
+
+    struct Range
+    {
+        Iterator First;
+        Iterator Last;
+
+        Iterator begin() const
+        {
+            return First;
+        }
+
+        Iterator end() const
+        {
+            return Last;
+        }
+    };
+
+    void Clear()
+    {
+        Offsets.clear();
+        Bytes.clear();
+
+        Edges = 0;
+    }
+
+    VertexId VertexCount() const
+    {
+        return Offsets.empty() ? 0 : static_cast<VertexId>(Offsets.size() - 1);
+    }
+
+    EdgeIndex EdgeCount() const
+    {
+        return Edges;
+    }
+
+    EdgeIndex Degree(VertexId Id) const
+    {
+        const uint8_t* Cursor{ Bytes.data() + Offsets[Id] };
+
+        return Decode(Cursor);
+    }
+
+    Range Neighbors(VertexId Id) const
+    {
+        Iterator First{ Bytes.data() + Offsets[Id], 0, 0 };
+
+        First.Remaining = Decode(First.Cursor);
+
+        if (First.Remaining)
+        {
+            const uint64_t Zigzag{ Decode(First.Cursor) };
+            const int64_t Difference{ static_cast<int64_t>(Zigzag >> 1) ^ -static_cast<int64_t>(Zigzag & 1) };
+
+            First.Current = static_cast<VertexId>(static_cast<int64_t>(Id) + Difference);
+        }
+
+        return { First, Iterator{ nullptr, 0, 0 } };
+    }
+
+    size_t MemoryBytes() const
+    {
+        return Offsets.size() * sizeof(EdgeIndex) + Bytes.size();
+    }
+
+    void Build(const CsrAdjacency& Base, unsigned int ThreadCount = 0)
+    {
+        //
+        // Size every list, place them with a prefix sum, then encode them,
+        // both passes in parallel over the vertices.
+        //
+
+        const VertexId Count{ Base.VertexCount() };
+
+        Offsets.assign(static_cast<size_t>(Count) + 1, 0);
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t u = Begin; u < End; ++u)
+            {
+                Offsets[u + 1] = Encode(Base, static_cast<VertexId>(u), nullptr);
+            }
+        }, 256);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Offsets[v + 1] += Offsets[v];
+        }
+
+        Bytes.resize(Offsets[Count]);
+        Edges = Base.EdgeCount();
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t u = Begin; u < End; ++u)
+            {
+                Encode(Base, static_cast<VertexId>(u), Bytes.data() + Offsets[u]);
+            }
+        }, 256);
+    }
+
+    void Build(VertexId Count, const std::vector<Edge>& SortedEdges, unsigned int ThreadCount = 0)
+    {
+        //
+        // Encodes straight from an edge list sorted by source, then target,
+        // so a loader never has to hold a CsrAdjacency next to the encoded
+        // bytes. Parallel edges are collapsed as CsrAdjacency::Build does;
+        // each vertex finds its run with a binary search.
+        //
+
+        auto RunOf = [&SortedEdges](VertexId u)
+        {
+            auto BySource = [](const Edge& e, VertexId Id)
+            {
+                return e.first < Id;
+            };
+
+            const auto First{ std::lower_bound(SortedEdges.begin(), SortedEdges.end(), u, BySource) };
+
+            return std::make_pair(First, std::lower_bound(First, SortedEdges.end(), u + 1, BySource));
+        };
+
+        auto TargetOf = [](const Edge& e)
+        {
+            return e.second;
+        };
+
+        Offsets.assign(static_cast<size_t>(Count) + 1, 0);
+        Edges = 0;
+
+        std::vector<EdgeIndex> Degrees(Count);
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            EdgeIndex Kept{ 0 };
+
+            for (size_t u = Begin; u < End; ++u)
+            {
+                const auto Run{ RunOf(static_cast<VertexId>(u)) };
+
+                for (auto it = Run.first; it != Run.second; ++it)
+                {
+                    Degrees[u] += ((it == Run.first) || (it->second != (it - 1)->second)) ? 1u : 0u;
+                }
+
+                Kept += Degrees[u];
+                Offsets[u + 1] = Encode(static_cast<VertexId>(u), Degrees[u], Run.first, Run.second, TargetOf, nullptr);
+            }
+
+            std::atomic_ref<EdgeIndex>(Edges).fetch_add(Kept, std::memory_order_relaxed);
+        }, 256);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Offsets[v + 1] += Offsets[v];
+        }
+
+        Bytes.resize(Offsets[Count]);
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t u = Begin; u < End; ++u)
+            {
+                const auto Run{ RunOf(static_cast<VertexId>(u)) };
+
+                Encode(static_cast<VertexId>(u), Degrees[u], Run.first, Run.second, TargetOf, Bytes.data() + Offsets[u]);
+            }
+        }, 256);
+    }
+
+private:
+
+    static uint64_t Decode(const uint8_t*& Cursor)
+    {
+        uint64_t Value{ static_cast<uint64_t>(*Cursor & 0x7f) };
+
+        for (unsigned int Shift = 7; *Cursor++ & 0x80; Shift += 7)
+        {
+            Value |= static_cast<uint64_t>(*Cursor & 0x7f) << Shift;
+        }
+
+        return Value;
+    }
+
+    static size_t Put(uint64_t Value, uint8_t* Out)
+    {
+        //
+        // Writes Value at Out unless it is null; returns the size either way.
+        //
+
+        size_t Size{ 1 };
+
+        for (; Value >= 0x80; Value >>= 7, ++Size)
+        {
+            if (Out)
+            {
+                *Out++ = static_cast<uint8_t>(Value | 0x80);
+            }
+        }
+
+        if (Out)
+        {
+            *Out = static_cast<uint8_t>(Value);
+        }
+
+        return Size;
+    }
+
+    static EdgeIndex Encode(const CsrAdjacency& Base, VertexId u, uint8_t* Out)
+    {
+        return Encode(u, Base.Degree(u), Base.Begin(u), Base.End(u), [](VertexId Target)
+        {
+            return Target;
+        }, Out);
+    }
+
+    template <typename Iterator, typename Project>
+    static EdgeIndex Encode(VertexId u, EdgeIndex Degree, Iterator First, Iterator Last, Project&& TargetOf, uint8_t* Out)
+    {
+        //
+        // Degree is the number of distinct targets in First .. Last; a
+        // target equal to the one before it is skipped.
+        //
+
+        size_t Size{ Put(Degree, Out) };
+
+        for (Iterator it = First; it != Last; ++it)
+        {
+            uint64_t Value;
+
+            if (it != First)
+            {
+                if (TargetOf(*it) == TargetOf(*(it - 1)))
+                {
+                    continue;
+                }
+
+                Value = TargetOf(*it) - TargetOf(*(it - 1)) - 1;
+            }
+            else
+            {
+                const int64_t Difference{ static_cast<int64_t>(TargetOf(*it)) - static_cast<int64_t>(u) };
+
+                Value = (static_cast<uint64_t>(Difference) << 1) ^ static_cast<uint64_t>(Difference >> 63);
+            }
+
+            Size += Put(Value, Out ? Out + Size : nullptr);
+        }
+
+        return Size;
+    }
+};
+
+//
+// Indexed d-ary min-heap of vertices keyed by weight, with decrease-key.
+// Keys sit next to the ids in the node array so sifting stays within a few
+// cache lines, and a wider fan-out than binary makes the tree shallower.
+// Position maps a vertex to its node, or InvalidVertex when not queued.
+//
+
+template <unsigned int Arity = 4>
+struct IndexedHeap
+{
+    struct Node
+    {
+        Weight Key;
+        VertexId Id;
+    };
+
+    std::vector<Node> Nodes;
+    std::vector<VertexId> Position;
+
+    void Reset(VertexId Count)
+    {
+        if (Position.size() != Count)
+        {
+            Position.assign(Count, InvalidVertex);
+        }
+        else
+        {
+            for (const Node& node : Nodes)
+            {
+                Position[node.Id] = InvalidVertex;
+            }
+        }
+
+        Nodes.clear();
+    }
+
+    bool Empty() const
+    {
+        return Nodes.empty();
+    }
+
+    void Push(VertexId Id, Weight Key)
+    {
+        //
+        // Insert, or lower the key of a vertex that is already queued.
+        //
+
+        size_t Index{ Position[Id] };
+
+        if (Index == InvalidVertex)
+        {
+            Index = Nodes.size();
+            Nodes.push_back(Node{ Key, Id });
+        }
+        else if (Key < Nodes[Index].Key)
+        {
+            Nodes[Index].Key = Key;
+        }
+        else
+        {
+            return;
+        }
+
+        SiftUp(Index);
+    }
+
+    Node Pop()
+    {
+        const Node Top{ Nodes.front() };
+
+        Position[Top.Id] = InvalidVertex;
+
+        const Node Last{ Nodes.back() };
+
+        Nodes.pop_back();
+
+        if (!Nodes.empty())
+        {
+            Nodes[0] = Last;
+            SiftDown(0);
+        }
+
+        return Top;
+    }
+
+private:
+
+    void Place(size_t Index, const Node& node)
+    {
+        Nodes[Index] = node;
+        Position[node.Id] = static_cast<VertexId>(Index);
+    }
+
+    void SiftUp(size_t Index)
+    {
+        const Node node{ Nodes[Index] };
+
+        while (Index > 0)
+        {
+            const size_t Parent{ (Index - 1) / Arity };
+
+            if (Nodes[Parent].Key <= node.Key)
+            {
+                break;
+            }
+
+            Place(Index, Nodes[Parent]);
+            Index = Parent;
+        }
+
+        Place(Index, node);
+    }
+
+    void SiftDown(size_t Index)
+    {
+        const Node node{ Nodes[Index] };
+        const size_t Count{ Nodes.size() };
+
+        for (;;)
+        {
+            const size_t First{ Index * Arity + 1 };
+
+            if (First >= Count)
+            {
+                break;
+            }
+
+            const size_t Last{ std::min(First + Arity, Count) };
+
+            size_t Best{ First };
+
+            for (size_t Child = First + 1; Child < Last; ++Child)
+            {
+                if (Nodes[Child].Key < Nodes[Best].Key)
+                {
+                    Best = Child;
+                }
+            }
+
+            if (Nodes[Best].Key >= node.Key)
+            {
+                break;
+            }
+
+            Place(Index, Nodes[Best]);
+            Index = Best;
+        }
+
+        Place(Index, node);
+    }
+};
+
+//
+// Scratch state of a Dijkstra query. Cost[v] is only meaningful where
+// Labeled is set; Settled marks the vertices whose cost is final and
+// Wanted the targets still to be settled.
+//
+
+struct DijkstraState
+{
+    IndexedHeap<4> Queue;
+    VisitedEpochs Labeled;
+    VisitedEpochs Settled;
+    VisitedEpochs Wanted;
+    std::vector<Weight> Cost;
+
+    void Reset(VertexId Count)
+    {
+        Queue.Reset(Count);
+        Labeled.Reset(Count);
+        Settled.Reset(Count);
+        Wanted.Reset(Count);
+        Cost.resize(Count);
+    }
+};
+
+//
+// Result of the array-based traversals: per-vertex hop distance from the
+// source (-1 when unreached) and BFS tree parent (InvalidVertex for the
+// source and unreached vertices).
+//
+
+struct BfsResult
+{
+    std::vector<int> Distances;
+    std::vector<VertexId> Parents;
+
+    VertexId Reached{ 0 };
+    EdgeIndex EdgesExamined{ 0 };
+};
+
+//
+// Direction-optimizing BFS switching heuristics (Beamer, Asanovic and
+// Patterson). Go bottom-up once the edges out of the frontier exceed
+// 1/Alpha of the edges left to explore; come back top-down once the
+// frontier shrinks below 1/Beta of the vertices.
+//
+
+struct BfsTuning
+{
+    unsigned int Alpha{ 15 };
+    unsigned int Beta{ 18 };
+};
+
+//
+// Disjoint-set forest with union by rank and path halving (a one-pass form
+// of path compression).
+//
+
+struct UnionFind
+{
+    std::vector<VertexId> Parent;
+    std::vector<uint8_t> Rank;
+
+    void Reset(VertexId Count)
+    {
+        Parent.resize(Count);
+        Rank.assign(Count, 0);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Parent[v] = v;
+        }
+    }
+
+    VertexId Find(VertexId Id)
+    {
+        while (Parent[Id] != Id)
+        {
+            Parent[Id] = Parent[Parent[Id]];
+            Id = Parent[Id];
+        }
+
+        return Id;
+    }
+
+    bool Union(VertexId First, VertexId Second)
+    {
+        First = Find(First);
+        Second = Find(Second);
+
+        if (First == Second)
+        {
+            return false;
+        }
+
+        if (Rank[First] < Rank[Second])
+        {
+            std::swap(First, Second);
+        }
+
+        Parent[Second] = First;
+
+        if (Rank[First] == Rank[Second])
+        {
+            ++Rank[First];
+        }
+
+        return true;
+    }
+};
+
+//
+// Connected components: a dense component id per vertex, in order of first
+// appearance, along with the component count and extreme sizes.
+//
+
+struct ComponentsResult
+{
+    std::vector<VertexId> Labels;
+
+    VertexId Count{ 0 };
+    unsigned int SmallestComponent{ 0 };
+    unsigned int LargestComponent{ 0 };
+
+    void FromRoots(const std::vector<VertexId>& Roots)
+    {
+        //
+        // Roots[v] names any representative of the component of v. Map the
+        // representatives to dense labels and tally the sizes.
+        //
+
+        const VertexId Vertices{ static_cast<VertexId>(Roots.size()) };
+
+        std::vector<VertexId> Dense(Vertices, InvalidVertex);
+        std::vector<unsigned int> Sizes;
+
+        Labels.resize(Vertices);
+
+        for (VertexId v = 0; v < Vertices; ++v)
+        {
+            VertexId& Label{ Dense[Roots[v]] };
+
+            if (Label == InvalidVertex)
+            {
+                Label = static_cast<VertexId>(Sizes.size());
+                Sizes.push_back(0);
+            }
+
+            Labels[v] = Label;
+            ++Sizes[Label];
+        }
+
+        Count = static_cast<VertexId>(Sizes.size());
+        SmallestComponent = Sizes.empty() ? 0 : *std::min_element(Sizes.begin(), Sizes.end());
+        LargestComponent = Sizes.empty() ? 0 : *std::max_element(Sizes.begin(), Sizes.end());
+    }
+};
+
+//
+// The bulk traversals, over any adjacency type with Neighbors() and
+// Degree(): the Graph methods run them on its CSR, and they run the same
+// on a DynamicAdjacency. Vertices are dense ids; an unknown source (one
+// past the vertex range, or InvalidVertex) reaches nothing.
+//
+
+template <typename Adjacency>
+BfsResult DirectionOptimizingBfs(const Adjacency& Out, const Adjacency& In, VertexId Source, const BfsTuning& Tuning = BfsTuning())
+{
+    const VertexId Count{ Out.VertexCount() };
+
+    BfsResult Result;
+
+    Result.Distances.assign(Count, -1);
+    Result.Parents.assign(Count, InvalidVertex);
+
+    if (Source >= Count)
+    {
+        return Result;
+    }
+
+    const EdgeIndex Alpha{ std::max(Tuning.Alpha, 1u) };
+    const VertexId Beta{ std::max(Tuning.Beta, 1u) };
+
+    std::vector<VertexId> Frontier;
+    std::vector<VertexId> Next;
+
+    VisitedBitmap FrontierBits;
+    VisitedBitmap NextBits;
+
+    Result.Distances[Source] = 0;
+    Result.Reached = 1;
+    Frontier.push_back(Source);
+
+    //
+    // ScoutCount is the number of edges out of the frontier, EdgesToCheck
+    // the number of edges out of vertices not visited yet.
+    //
+
+    EdgeIndex EdgesToCheck{ Out.EdgeCount() };
+    EdgeIndex ScoutCount{ Out.Degree(Source) };
+
+    int Level{ 0 };
+
+    while (!Frontier.empty())
+    {
+        if (ScoutCount > EdgesToCheck / Alpha)
+        {
+            //
+            // Bottom-up: every unvisited vertex looks for any parent in the
+            // frontier and stops at the first one it finds.
+            //
+
+            FrontierBits.Reset(Count);
+
+            for (VertexId v : Frontier)
+            {
+                FrontierBits.Set(v);
+            }
+
+            VertexId Awake{ static_cast<VertexId>(Frontier.size()) };
+            VertexId PreviousAwake;
+
+            do
+            {
+                PreviousAwake = Awake;
+                Awake = 0;
+
+                NextBits.Reset(Count);
+
+                for (VertexId v = 0; v < Count; ++v)
+                {
+                    if (Result.Distances[v] >= 0)
+                    {
+                        continue;
+                    }
+
+                    for (VertexId Parent : In.Neighbors(v))
+                    {
+                        ++Result.EdgesExamined;
+
+                        if (FrontierBits.Test(Parent))
+                        {
+                            Result.Parents[v] = Parent;
+                            Result.Distances[v] = Level + 1;
+                            NextBits.Set(v);
+                            ++Awake;
+                            break;
+                        }
+                    }
+                }
+
+                std::swap(FrontierBits, NextBits);
+
+                Result.Reached += Awake;
+                ++Level;
+            }
+            while ((Awake >= PreviousAwake) || (Awake > Count / Beta));
+
+            //
+            // Back to top-down: turn the frontier bitmap into a queue.
+            //
+
+            Frontier.clear();
+
+            for (VertexId v = 0; v < Count; ++v)
+            {
+                if (FrontierBits.Test(v))
+                {
+                    Frontier.push_back(v);
+                }
+            }
+
+            ScoutCount = 1;
+        }
+        else
+        {
+            //
+            // Top-down: the frontier pushes to its unvisited neighbors.
+            //
+
+            EdgesToCheck -= std::min(EdgesToCheck, ScoutCount);
+            ScoutCount = 0;
+
+            Next.clear();
+
+            for (VertexId u : Frontier)
+            {
+                for (VertexId v : Out.Neighbors(u))
+                {
+                    ++Result.EdgesExamined;
+
+                    if (Result.Distances[v] < 0)
+                    {
+                        Result.Parents[v] = u;
+                        Result.Distances[v] = Level + 1;
+                        Next.push_back(v);
+
+                        ScoutCount += Out.Degree(v);
+                    }
+                }
+            }
+
+            std::swap(Frontier, Next);
+
+            Result.Reached += static_cast<VertexId>(Frontier.size());
+            ++Level;
+        }
+    }
+
+    return Result;
+}
+
+template <typename Adjacency>
+BfsResult ParallelBfs(const Adjacency& Out, VertexId Source, unsigned int ThreadCount = 0)
+{
+    const VertexId Count{ Out.VertexCount() };
+
+    BfsResult Result;
+
+    Result.Distances.assign(Count, -1);
+    Result.Parents.assign(Count, InvalidVertex);
+
+    if (Source >= Count)
+    {
+        return Result;
+    }
+
+    //
+    // Level-synchronous top-down BFS. Workers grab chunks of the current
+    // frontier and claim unvisited neighbors with a compare-and-swap on
+    // their distance; the winner records the parent and appends the vertex
+    // to its own next-frontier buffer. At the end of the level the buffers
+    // are sized (first barrier), copied side by side into the shared next
+    // frontier (second barrier), and the frontiers are swapped.
+    //
+
+    constexpr size_t ChunkSize{ 256 };
+
+    const unsigned int Workers{ WorkerCount(ThreadCount) };
+
+    std::vector<VertexId> Frontier{ Source };
+    std::vector<VertexId> Next;
+
+    std::vector<std::vector<VertexId>> Local(Workers);
+    std::vector<size_t> LocalOffsets(Workers + 1, 0);
+    std::vector<EdgeIndex> Examined(Workers, 0);
+
+    std::atomic<size_t> Cursor{ 0 };
+
+    int Level{ 0 };
+    bool Sized{ false };
+    bool Done{ false };
+
+    Result.Distances[Source] = 0;
+    Result.Reached = 1;
+
+    auto EndOfPhase = [&]() noexcept
+    {
+        if (!Sized)
+        {
+            for (unsigned int t = 0; t < Workers; ++t)
+            {
+                LocalOffsets[t + 1] = LocalOffsets[t] + Local[t].size();
+            }
+
+            Next.resize(LocalOffsets[Workers]);
+        }
+        else
+        {
+            std::swap(Frontier, Next);
+
+            Result.Reached += static_cast<VertexId>(Frontier.size());
+            Cursor.store(0, std::memory_order_relaxed);
+
+            Done = Frontier.empty();
+            ++Level;
+        }
+
+        Sized = !Sized;
+    };
+
+    std::barrier Sync(static_cast<ptrdiff_t>(Workers), EndOfPhase);
+
+    auto Worker = [&](unsigned int Index)
+    {
+        std::vector<VertexId>& Mine{ Local[Index] };
+
+        while (!Done)
+        {
+            for (;;)
+            {
+                const size_t Begin{ Cursor.fetch_add(ChunkSize, std::memory_order_relaxed) };
+
+                if (Begin >= Frontier.size())
+                {
+                    break;
+                }
+
+                const size_t End{ std::min(Begin + ChunkSize, Frontier.size()) };
+
+                for (size_t i = Begin; i < End; ++i)
+                {
+                    const VertexId u{ Frontier[i] };
+
+                    Examined[Index] += Out.Degree(u);
+
+                    for (VertexId v : Out.Neighbors(u))
+                    {
+                        std::atomic_ref<int> Distance(Result.Distances[v]);
+
+                        int Unvisited{ -1 };
+
+                        if ((Distance.load(std::memory_order_relaxed) < 0) &&
+                            Distance.compare_exchange_strong(Unvisited, Level + 1, std::memory_order_relaxed))
+                        {
+                            Result.Parents[v] = u;
+                            Mine.push_back(v);
+                        }
+                    }
+                }
+            }
+
+            Sync.arrive_and_wait();
+
+            std::copy(Mine.begin(), Mine.end(), Next.begin() + static_cast<ptrdiff_t>(LocalOffsets[Index]));
+            Mine.clear();
+
+            Sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> Threads;
+
+    for (unsigned int t = 1; t < Workers; ++t)
+    {
+        Threads.emplace_back(Worker, t);
+    }
+
+    Worker(0);
+
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    for (EdgeIndex PerWorker : Examined)
+    {
+        Result.EdgesExamined += PerWorker;
+    }
+
+    return Result;
+}
+
+inline void AfforestLink(std::vector<VertexId>& Comp, VertexId u, VertexId v)
+{
+    //
+    // Hook the higher of the two roots under the lower one with a CAS,
+    // chasing the parents again whenever another thread got there first.
+    //
+
+    auto Load = [&Comp](VertexId Id)
+    {
+        return std::atomic_ref<VertexId>(Comp[Id]).load(std::memory_order_relaxed);
+    };
+
+    VertexId p1{ Load(u) };
+    VertexId p2{ Load(v) };
+
+    while (p1 != p2)
+    {
+        const VertexId High{ std::max(p1, p2) };
+        const VertexId Low{ std::min(p1, p2) };
+
+        VertexId pHigh{ Load(High) };
+
+        if (pHigh == Low)
+        {
+            break;
+        }
+
+        if ((pHigh == High) &&
+            std::atomic_ref<VertexId>(Comp[High]).compare_exchange_strong(pHigh, Low, std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        p1 = Load(Load(High));
+        p2 = Load(Low);
+    }
+}
+
+inline void AfforestCompress(std::vector<VertexId>& Comp, unsigned int ThreadCount)
+{
+    ParallelFor(Comp.size(), ThreadCount, [&Comp](size_t Begin, size_t End)
+    {
+        for (size_t n = Begin; n < End; ++n)
+        {
+            std::atomic_ref<VertexId> Self(Comp[n]);
+
+            for (;;)
+            {
+                const VertexId Parent{ Self.load(std::memory_order_relaxed) };
+                const VertexId GrandParent{ std::atomic_ref<VertexId>(Comp[Parent]).load(std::memory_order_relaxed) };
+
+                if (Parent == GrandParent)
+                {
+                    break;
+                }
+
+                Self.store(GrandParent, std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+template <typename Adjacency>
+ComponentsResult ParallelComponents(const Adjacency& Out, std::type_identity_t<const Adjacency*> In, unsigned int ThreadCount = 0, unsigned int NeighborRounds = 2)
+{
+    //
+    // Afforest (Sutton, Ben-Nun and Barak). Link every vertex to its first
+    // few neighbors only, which already merges most of the giant component.
+    // Then find that component by sampling and link the remaining edges of
+    // every vertex outside of it. Links are lock-free CAS hooks of the
+    // larger root under the smaller.
+    //
+    // Directed graphs also need the in-edges (In, null otherwise): an edge
+    // from the giant component into a vertex outside of it is only seen
+    // from that side.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    std::vector<VertexId> Comp(Count);
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        Comp[v] = v;
+    }
+
+    for (unsigned int Round = 0; Round < NeighborRounds; ++Round)
+    {
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (VertexId u = static_cast<VertexId>(Begin); u < End; ++u)
+            {
+                unsigned int Index{ 0 };
+
+                for (VertexId v : Out.Neighbors(u))
+                {
+                    if (Index++ == Round)
+                    {
+                        AfforestLink(Comp, u, v);
+                        break;
+                    }
+                }
+            }
+        });
+
+        AfforestCompress(Comp, ThreadCount);
+    }
+
+    VertexId Giant{ InvalidVertex };
+
+    if (Count)
+    {
+        std::mt19937 Random(27491095);
+        std::uniform_int_distribution<VertexId> Pick(0, Count - 1);
+        std::map<VertexId, unsigned int> Samples;
+
+        for (int i = 0; i < 1024; ++i)
+        {
+            ++Samples[Comp[Pick(Random)]];
+        }
+
+        Giant = std::max_element(Samples.begin(), Samples.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+    }
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (VertexId u = static_cast<VertexId>(Begin); u < End; ++u)
+        {
+            if (std::atomic_ref<VertexId>(Comp[u]).load(std::memory_order_relaxed) == Giant)
+            {
+                continue;
+            }
+
+            unsigned int Skipped{ 0 };
+
+            for (VertexId v : Out.Neighbors(u))
+            {
+                if (Skipped < NeighborRounds)
+                {
+                    ++Skipped;
+                }
+                else
+                {
+                    AfforestLink(Comp, u, v);
+                }
+            }
+
+            if (In)
+            {
+                for (VertexId v : In->Neighbors(u))
+                {
+                    AfforestLink(Comp, u, v);
+                }
+            }
+        }
+    });
+
+    AfforestCompress(Comp, ThreadCount);
+
+    ComponentsResult Result;
+
+    Result.FromRoots(Comp);
+
+    return Result;
+}
+
+template <typename Adjacency>
+void MultiSourceBfsBatch(const Adjacency& Out, const VertexId* Sources, size_t SourceCount, std::vector<int>* Distances,
+                         std::vector<uint64_t>& Seen, std::vector<uint64_t>& Visit, std::vector<uint64_t>& VisitNext)
+{
+    //
+    // One batch of up to 64 BFS traversals (Then et al., "The More the
+    // Merrier"). Bit i of Seen[v] says search i has reached v, Visit holds
+    // the current frontiers of all searches at once. A vertex on several
+    // frontiers has its neighbor list scanned once per level, for all of
+    // them, with a single OR per edge.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    Seen.assign(Count, 0);
+    Visit.assign(Count, 0);
+    VisitNext.assign(Count, 0);
+
+    for (size_t i = 0; i < SourceCount; ++i)
+    {
+        const uint64_t Bit{ 1ull << i };
+
+        Seen[Sources[i]] |= Bit;
+        Visit[Sources[i]] |= Bit;
+
+        Distances[i].assign(Count, -1);
+        Distances[i][Sources[i]] = 0;
+    }
+
+    for (int Level = 1; ; ++Level)
+    {
+        bool Active{ false };
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            const uint64_t Frontier{ Visit[v] };
+
+            if (Frontier == 0)
+            {
+                continue;
+            }
+
+            for (VertexId Neighbor : Out.Neighbors(v))
+            {
+                VisitNext[Neighbor] |= Frontier;
+            }
+        }
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            uint64_t Discovered{ VisitNext[v] & ~Seen[v] };
+
+            VisitNext[v] = 0;
+            Visit[v] = Discovered;
+
+            if (Discovered == 0)
+            {
+                continue;
+            }
+
+            Seen[v] |= Discovered;
+            Active = true;
+
+            while (Discovered)
+            {
+                Distances[std::countr_zero(Discovered)][v] = Level;
+                Discovered &= (Discovered - 1);
+            }
+        }
+
+        if (!Active)
+        {
+            break;
+        }
+    }
+}
+
+template <typename Adjacency>
+std::vector<std::vector<int>> MultiSourceBfs(const Adjacency& Out, const std::vector<VertexId>& Sources, unsigned int ThreadCount = 0)
+{
+    //
+    // Hop distances from each source to every vertex, -1 where unreachable
+    // (and everywhere for unknown sources). The sources are cut into
+    // batches of 64 bit-parallel traversals, and the batches are spread
+    // over the worker threads.
+    //
+
+    constexpr size_t BatchSize{ 64 };
+
+    std::vector<std::vector<int>> Distances(Sources.size());
+    std::vector<VertexId> Known;
+    std::vector<size_t> Slots;
+
+    for (size_t i = 0; i < Sources.size(); ++i)
+    {
+        if (Sources[i] >= Out.VertexCount())
+        {
+            Distances[i].assign(Out.VertexCount(), -1);
+        }
+        else
+        {
+            Known.push_back(Sources[i]);
+            Slots.push_back(i);
+        }
+    }
+
+    const size_t Batches{ (Known.size() + BatchSize - 1) / BatchSize };
+
+    ParallelFor(Batches, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        std::vector<uint64_t> Seen;
+        std::vector<uint64_t> Visit;
+        std::vector<uint64_t> VisitNext;
+        std::vector<int> Batch[BatchSize];
+
+        for (size_t b = Begin; b < End; ++b)
+        {
+            const size_t First{ b * BatchSize };
+            const size_t Size{ std::min(BatchSize, Known.size() - First) };
+
+            MultiSourceBfsBatch(Out, Known.data() + First, Size, Batch, Seen, Visit, VisitNext);
+
+            for (size_t i = 0; i < Size; ++i)
+            {
+                Distances[Slots[First + i]] = std::move(Batch[i]);
+            }
+        }
+    }, 1);
+
+    return Distances;
+}
+
+//
+// PageRank tuning: iteration stops once the L1 norm of the change in the
+// ranks drops below Tolerance, or after MaxIterations. A ThreadCount of 0
+// means one worker per hardware thread.
+//
+
+struct PageRankOptions
+{
+    float Damping{ 0.85f };
+    float Tolerance{ 1e-5f };
+    unsigned int MaxIterations{ 100 };
+    unsigned int ThreadCount{ 0 };
+};
+
+struct PageRankResult
+{
+    std::vector<float> Ranks;
+    unsigned int Iterations{ 0 };
+    double Change{ 0 };
+};
+
+template <typename Adjacency>
+PageRankResult PageRank(const Adjacency& Out, const Adjacency& In, const std::vector<VertexId>& Seeds = {}, const PageRankOptions& Options = PageRankOptions())
+{
+    //
+    // Pull-direction power iteration: each vertex sums the contributions
+    // of its in-neighbors, so every rank is written by one thread only and
+    // no atomics are needed. The contributions (rank over out-degree) are
+    // computed once per iteration into their own array, which keeps the
+    // inner loop a plain gather and sum of floats, and the update of the
+    // ranks a separate loop the compiler can vectorize.
+    //
+    // The random surfer teleports uniformly, or only to the Seeds when
+    // there are any (personalized PageRank); dangling vertices hand their
+    // rank out the same way. Seeds outside the graph are ignored, and a
+    // seed list with none inside it ranks every vertex 0.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+    const float Damping{ Options.Damping };
+
+    PageRankResult Result;
+
+    std::vector<float> Teleport(Count, 0);
+    std::vector<float> InverseDegree(Count);
+    std::vector<float> Contribution(Count);
+    std::vector<float> Next(Count);
+
+    if (Seeds.empty())
+    {
+        std::fill(Teleport.begin(), Teleport.end(), 1.0f / static_cast<float>(std::max<VertexId>(Count, 1)));
+    }
+    else
+    {
+        for (VertexId Seed : Seeds)
+        {
+            if (Seed < Count)
+            {
+                Teleport[Seed] = 1;
+            }
+        }
+
+        const float Total{ std::accumulate(Teleport.begin(), Teleport.end(), 0.0f) };
+
+        if (Total == 0)
+        {
+            Result.Ranks.assign(Count, 0);
+
+            return Result;
+        }
+
+        for (float& Share : Teleport)
+        {
+            Share /= Total;
+        }
+    }
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        const EdgeIndex Degree{ Out.Degree(v) };
+
+        InverseDegree[v] = Degree ? 1.0f / static_cast<float>(Degree) : 0.0f;
+    }
+
+    Result.Ranks = Teleport;
+
+    while (Result.Iterations < Options.MaxIterations)
+    {
+        std::atomic<double> Dangling{ 0 };
+        std::atomic<double> Change{ 0 };
+
+        ParallelFor(Count, Options.ThreadCount, [&](size_t Begin, size_t End)
+        {
+            double Lost{ 0 };
+
+            for (size_t v = Begin; v < End; ++v)
+            {
+                Contribution[v] = Result.Ranks[v] * InverseDegree[v];
+                Lost += (InverseDegree[v] == 0) ? Result.Ranks[v] : 0.0f;
+            }
+
+            Dangling.fetch_add(Lost, std::memory_order_relaxed);
+        }, 4096);
+
+        const float Redistributed{ static_cast<float>(Dangling.load()) };
+
+        ParallelFor(Count, Options.ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t v = Begin; v < End; ++v)
+            {
+                float Sum{ 0 };
+
+                for (VertexId u : In.Neighbors(static_cast<VertexId>(v)))
+                {
+                    Sum += Contribution[u];
+                }
+
+                Next[v] = Sum;
+            }
+
+            double Moved{ 0 };
+
+            for (size_t v = Begin; v < End; ++v)
+            {
+                const float Rank{ (1 - Damping) * Teleport[v] + Damping * (Next[v] + Redistributed * Teleport[v]) };
+
+                Moved += std::fabs(Rank - Result.Ranks[v]);
+                Next[v] = Rank;
+            }
+
+            Change.fetch_add(Moved, std::memory_order_relaxed);
+        }, 1024);
+
+        std::swap(Result.Ranks, Next);
+
+        ++Result.Iterations;
+        Result.Change = Change.load();
+
+        if (Result.Change < Options.Tolerance)
+        {
+            break;
+        }
+    }
+
+    return Result;
+}
+
+//
+// Calls Visit(x) for every x in both sorted ranges. When one range is much
+// shorter, each of its elements gallops through the other (exponential
+// then binary search) in O(m log(n / m)); otherwise a merge whose cursors
+// advance without branching on the comparison.
+//
+
+template <typename Visit>
+inline void IntersectSorted(const VertexId* First, const VertexId* FirstEnd, const VertexId* Second, const VertexId* SecondEnd, Visit&& visit)
+{
+    constexpr ptrdiff_t GallopRatio{ 32 };
+
+    if ((FirstEnd - First) > (SecondEnd - Second))
+    {
+        std::swap(First, Second);
+        std::swap(FirstEnd, SecondEnd);
+    }
+
+    if ((FirstEnd - First) * GallopRatio < (SecondEnd - Second))
+    {
+        for (; First != FirstEnd; ++First)
+        {
+            ptrdiff_t Step{ 1 };
+
+            while ((Step < SecondEnd - Second) && (Second[Step] < *First))
+            {
+                Step *= 2;
+            }
+
+            Second = std::lower_bound(Second, Second + std::min(Step + 1, SecondEnd - Second), *First);
+
+            if (Second == SecondEnd)
+            {
+                break;
+            }
+
+            if (*Second == *First)
+            {
+                visit(*First);
+            }
+        }
+
+        return;
+    }
+
+    while ((First != FirstEnd) && (Second != SecondEnd))
+    {
+        const VertexId a{ *First };
+        const VertexId b{ *Second };
+
+        if (a == b)
+        {
+            visit(a);
+        }
+
+        First += (a <= b);
+        Second += (b <= a);
+    }
+}
+
+//
+// Triangle counts, per vertex and in total, and local clustering
+// coefficients: the fraction of pairs of neighbors that are neighbors of
+// each other. Edges are taken as undirected.
+//
+
+struct TriangleResult
+{
+    uint64_t Triangles{ 0 };
+    std::vector<uint64_t> PerVertex;
+    std::vector<double> Clustering;
+    double AverageClustering{ 0 };
+};
+
+template <typename Adjacency>
+CsrAdjacency OrientByDegree(const Adjacency& Out, std::type_identity_t<const Adjacency*> In, std::vector<EdgeIndex>& Degrees, unsigned int ThreadCount = 0)
+{
+    //
+    // Keeps every undirected edge once, pointing from the endpoint of lower
+    // degree to the one of higher degree (ties broken by id), so no vertex
+    // keeps more than O(sqrt(E)) out-neighbors. On a directed graph In
+    // holds the in-edges and both directions are merged; self-loops are
+    // dropped. Degrees receives the undirected degree of every vertex.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    auto Undirected = [&](VertexId u, std::vector<VertexId>& Scratch)
+    {
+        Scratch.clear();
+
+        for (VertexId v : Out.Neighbors(u))
+        {
+            Scratch.push_back(v);
+        }
+
+        if (In)
+        {
+            for (VertexId v : In->Neighbors(u))
+            {
+                Scratch.push_back(v);
+            }
+
+            std::sort(Scratch.begin(), Scratch.end());
+            Scratch.erase(std::unique(Scratch.begin(), Scratch.end()), Scratch.end());
+        }
+
+        Scratch.erase(std::remove(Scratch.begin(), Scratch.end(), u), Scratch.end());
+    };
+
+    auto Before = [&Degrees](VertexId u, VertexId v)
+    {
+        return (Degrees[u] < Degrees[v]) || ((Degrees[u] == Degrees[v]) && (u < v));
+    };
+
+    Degrees.assign(Count, 0);
+
+    CsrAdjacency Oriented;
+
+    Oriented.Offsets.assign(static_cast<size_t>(Count) + 1, 0);
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        std::vector<VertexId> Scratch;
+
+        for (size_t u = Begin; u < End; ++u)
+        {
+            Undirected(static_cast<VertexId>(u), Scratch);
+
+            Degrees[u] = Scratch.size();
+        }
+    }, 256);
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        std::vector<VertexId> Scratch;
+
+        for (size_t u = Begin; u < End; ++u)
+        {
+            Undirected(static_cast<VertexId>(u), Scratch);
+
+            Oriented.Offsets[u + 1] = static_cast<EdgeIndex>(std::count_if(Scratch.begin(), Scratch.end(),
+                [&](VertexId v) { return Before(static_cast<VertexId>(u), v); }));
+        }
+    }, 256);
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        Oriented.Offsets[v + 1] += Oriented.Offsets[v];
+    }
+
+    Oriented.Targets.resize(Oriented.Offsets[Count]);
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        std::vector<VertexId> Scratch;
+
+        for (size_t u = Begin; u < End; ++u)
+        {
+            Undirected(static_cast<VertexId>(u), Scratch);
+
+            std::copy_if(Scratch.begin(), Scratch.end(), Oriented.Targets.begin() + static_cast<ptrdiff_t>(Oriented.Offsets[u]),
+                [&](VertexId v) { return Before(static_cast<VertexId>(u), v); });
+        }
+    }, 256);
+
+    return Oriented;
+}
+
+template <typename Adjacency>
+uint64_t CountTriangles(const Adjacency& Out, std::type_identity_t<const Adjacency*> In, unsigned int ThreadCount = 0)
+{
+    //
+    // Every triangle is found exactly once, from its lowest-ranked vertex u
+    // as a common out-neighbor of u and of its out-neighbor v. Small
+    // chunks handed out dynamically even out the skew between vertices.
+    //
+
+    std::vector<EdgeIndex> Degrees;
+
+    const CsrAdjacency Oriented{ OrientByDegree(Out, In, Degrees, ThreadCount) };
+
+    std::atomic<uint64_t> Total{ 0 };
+
+    ParallelFor(Oriented.VertexCount(), ThreadCount, [&](size_t Begin, size_t End)
+    {
+        uint64_t Found{ 0 };
+
+        for (size_t u = Begin; u < End; ++u)
+        {
+            for (VertexId v : Oriented.Neighbors(static_cast<VertexId>(u)))
+            {
+                IntersectSorted(Oriented.Begin(static_cast<VertexId>(u)), Oriented.End(static_cast<VertexId>(u)),
+                                Oriented.Begin(v), Oriented.End(v), [&Found](VertexId) { ++Found; });
+            }
+        }
+
+        Total.fetch_add(Found, std::memory_order_relaxed);
+    }, 64);
+
+    return Total.load();
+}
+
+template <typename Adjacency>
+TriangleResult LocalTriangles(const Adjacency& Out, std::type_identity_t<const Adjacency*> In, unsigned int ThreadCount = 0)
+{
+    //
+    // Same enumeration as CountTriangles(), crediting each triangle to its
+    // three corners with atomic increments.
+    //
+
+    std::vector<EdgeIndex> Degrees;
+
+    const CsrAdjacency Oriented{ OrientByDegree(Out, In, Degrees, ThreadCount) };
+    const VertexId Count{ Oriented.VertexCount() };
+
+    TriangleResult Result;
+
+    Result.PerVertex.assign(Count, 0);
+    Result.Clustering.assign(Count, 0);
+
+    auto Credit = [&Result](VertexId v)
+    {
+        std::atomic_ref<uint64_t>(Result.PerVertex[v]).fetch_add(1, std::memory_order_relaxed);
+    };
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (VertexId u = static_cast<VertexId>(Begin); u < End; ++u)
+        {
+            for (VertexId v : Oriented.Neighbors(u))
+            {
+                IntersectSorted(Oriented.Begin(u), Oriented.End(u), Oriented.Begin(v), Oriented.End(v), [&](VertexId w)
+                {
+                    Credit(u);
+                    Credit(v);
+                    Credit(w);
+                });
+            }
+        }
+    }, 64);
+
+    double Sum{ 0 };
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        const double Degree{ static_cast<double>(Degrees[v]) };
+
+        Result.Triangles += Result.PerVertex[v];
+        Result.Clustering[v] = (Degrees[v] > 1) ? 2.0 * static_cast<double>(Result.PerVertex[v]) / (Degree * (Degree - 1)) : 0.0;
+
+        Sum += Result.Clustering[v];
+    }
+
+    Result.Triangles /= 3;
+    Result.AverageClustering = Count ? Sum / Count : 0;
+
+    return Result;
+}
+
+//
+// Strongly connected components: Component[v] is the component of v, from
+// 0 to Count - 1, and Condensation the DAG with one vertex per component
+// and an edge wherever an edge of the graph crosses between components.
+//
+
+struct SccResult
+{
+    std::vector<VertexId> Component;
+    VertexId Count{ 0 };
+    CsrAdjacency Condensation;
+};
+
+template <typename Adjacency>
+CsrAdjacency BuildCondensation(const Adjacency& Out, const std::vector<VertexId>& Component, VertexId Count, unsigned int ThreadCount = 0)
+{
+    std::vector<Edge> Crossing;
+
+    for (VertexId u = 0; u < Out.VertexCount(); ++u)
+    {
+        for (VertexId v : Out.Neighbors(u))
+        {
+            if (Component[u] != Component[v])
+            {
+                Crossing.push_back(Edge(Component[u], Component[v]));
+            }
+        }
+    }
+
+    CsrAdjacency Condensation;
+
+    Condensation.Build(Count, Crossing, false, {}, ThreadCount);
+
+    return Condensation;
+}
+
+template <typename Adjacency>
+SccResult StronglyConnectedComponents(const Adjacency& Out)
+{
+    //
+    // Tarjan's algorithm with an explicit stack of frames, each holding a
+    // vertex and its position in its neighbor list, so the depth of the
+    // graph is not limited by the depth of the call stack. Components come
+    // out, and are numbered, in reverse topological order of the
+    // condensation: sinks first.
+    //
+
+    using Cursor = decltype(Out.Neighbors(0).begin());
+
+    struct Frame
+    {
+        VertexId Vertex;
+        Cursor Next;
+        Cursor End;
+    };
+
+    constexpr VertexId Unvisited{ InvalidVertex };
+
+    const VertexId Count{ Out.VertexCount() };
+
+    SccResult Result;
+
+    Result.Component.assign(Count, InvalidVertex);
+
+    std::vector<VertexId> Index(Count, Unvisited);
+    std::vector<VertexId> Low(Count);
+    std::vector<VertexId> Stack;
+    std::vector<Frame> Frames;
+
+    VertexId Visited{ 0 };
+
+    auto Enter = [&](VertexId v)
+    {
+        const auto Neighbors{ Out.Neighbors(v) };
+
+        Index[v] = Low[v] = Visited++;
+        Stack.push_back(v);
+        Frames.push_back(Frame{ v, Neighbors.begin(), Neighbors.end() });
+    };
+
+    for (VertexId Root = 0; Root < Count; ++Root)
+    {
+        if (Index[Root] != Unvisited)
+        {
+            continue;
+        }
+
+        Enter(Root);
+
+        while (!Frames.empty())
+        {
+            Frame& Top{ Frames.back() };
+            const VertexId v{ Top.Vertex };
+
+            if (Top.Next != Top.End)
+            {
+                const VertexId w{ *Top.Next };
+
+                ++Top.Next;
+
+                if (Index[w] == Unvisited)
+                {
+                    Enter(w);
+                }
+                else if (Result.Component[w] == InvalidVertex)
+                {
+                    //
+                    // Still on the stack.
+                    //
+
+                    Low[v] = std::min(Low[v], Index[w]);
+                }
+
+                continue;
+            }
+
+            Frames.pop_back();
+
+            if (Low[v] == Index[v])
+            {
+                VertexId w;
+
+                do
+                {
+                    w = Stack.back();
+                    Stack.pop_back();
+
+                    Result.Component[w] = Result.Count;
+                }
+                while (w != v);
+
+                ++Result.Count;
+            }
+
+            if (!Frames.empty())
+            {
+                const VertexId Parent{ Frames.back().Vertex };
+
+                Low[Parent] = std::min(Low[Parent], Low[v]);
+            }
+        }
+    }
+
+    Result.Condensation = BuildCondensation(Out, Result.Component, Result.Count);
+
+    return Result;
+}
+
+template <typename Adjacency, typename Admit>
+void ParallelReach(const Adjacency& Adj, VertexId Source, std::vector<uint8_t>& Marks, uint8_t Mark, Admit&& admit, unsigned int ThreadCount)
+{
+    //
+    // Level-synchronous parallel search from Source, setting the Mark bit
+    // on every vertex it reaches through vertices accepted by Admit(v).
+    // Each chunk of the frontier collects what it claims locally, then
+    // reserves room for it in the next frontier with a single atomic add.
+    //
+
+    std::vector<VertexId> Frontier{ Source };
+    std::vector<VertexId> Next(Adj.VertexCount());
+
+    Marks[Source] |= Mark;
+
+    while (!Frontier.empty())
+    {
+        std::atomic<size_t> Size{ 0 };
+
+        ParallelFor(Frontier.size(), ThreadCount, [&](size_t Begin, size_t End)
+        {
+            std::vector<VertexId> Claimed;
+
+            for (size_t i = Begin; i < End; ++i)
+            {
+                for (VertexId w : Adj.Neighbors(Frontier[i]))
+                {
+                    std::atomic_ref<uint8_t> Flags(Marks[w]);
+
+                    if (!(Flags.load(std::memory_order_relaxed) & Mark) && admit(w) &&
+                        !(Flags.fetch_or(Mark, std::memory_order_relaxed) & Mark))
+                    {
+                        Claimed.push_back(w);
+                    }
+                }
+            }
+
+            std::copy(Claimed.begin(), Claimed.end(), Next.begin() + static_cast<ptrdiff_t>(Size.fetch_add(Claimed.size(), std::memory_order_relaxed)));
+        }, 64);
+
+        Frontier.assign(Next.begin(), Next.begin() + static_cast<ptrdiff_t>(Size.load()));
+    }
+}
+
+template <typename Adjacency>
+SccResult ParallelStronglyConnectedComponents(const Adjacency& Out, const Adjacency& In, unsigned int ThreadCount = 0)
+{
+    //
+    // Multistep (Slota, Rajamanickam and Madduri), in three phases:
+    //
+    // 1. Trim: a vertex with no in-edge or no out-edge is a component on
+    //    its own.
+    //
+    // 2. Forward-backward from a pivot of high degree: the vertices it
+    //    reaches and that reach it form its component, which on real
+    //    graphs is usually the giant one.
+    //
+    // 3. Coloring for what is left: every vertex takes the largest id that
+    //    reaches it, by propagating maxima forward to a fixed point. A
+    //    vertex that kept its own color is the root of a component made of
+    //    the vertices of that color which reach it, found by a backward
+    //    search within the color. Repeat until every vertex is assigned.
+    //
+    // Component numbers carry no particular order.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    SccResult Result;
+
+    Result.Component.assign(Count, InvalidVertex);
+
+    std::atomic<VertexId> Numbered{ 0 };
+
+    auto Assigned = [&Result](VertexId v)
+    {
+        return std::atomic_ref<VertexId>(Result.Component[v]).load(std::memory_order_relaxed) != InvalidVertex;
+    };
+
+    auto Assign = [&Result](VertexId v, VertexId Id)
+    {
+        std::atomic_ref<VertexId>(Result.Component[v]).store(Id, std::memory_order_relaxed);
+    };
+
+    auto HasActive = [&](const auto& Neighbors, VertexId Self)
+    {
+        for (VertexId w : Neighbors)
+        {
+            if ((w != Self) && !Assigned(w))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (VertexId v = static_cast<VertexId>(Begin); v < End; ++v)
+        {
+            if (!HasActive(Out.Neighbors(v), v) || !HasActive(In.Neighbors(v), v))
+            {
+                Assign(v, Numbered.fetch_add(1, std::memory_order_relaxed));
+            }
+        }
+    });
+
+    VertexId Pivot{ InvalidVertex };
+    EdgeIndex Best{ 0 };
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        if (!Assigned(v) && ((Pivot == InvalidVertex) || (Out.Degree(v) * In.Degree(v) > Best)))
+        {
+            Pivot = v;
+            Best = Out.Degree(v) * In.Degree(v);
+        }
+    }
+
+    if (Pivot != InvalidVertex)
+    {
+        constexpr uint8_t Forward{ 1 };
+        constexpr uint8_t Backward{ 2 };
+
+        std::vector<uint8_t> Marks(Count, 0);
+
+        ParallelReach(Out, Pivot, Marks, Forward, [&](VertexId w) { return !Assigned(w); }, ThreadCount);
+        ParallelReach(In, Pivot, Marks, Backward, [&](VertexId w) { return (Marks[w] & Forward) != 0; }, ThreadCount);
+
+        const VertexId Giant{ Numbered.fetch_add(1) };
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t v = Begin; v < End; ++v)
+            {
+                if (Marks[v] & Backward)
+                {
+                    Result.Component[v] = Giant;
+                }
+            }
+        });
+    }
+
+    std::vector<VertexId> Active;
+    std::vector<VertexId> Color(Count);
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        if (!Assigned(v))
+        {
+            Active.push_back(v);
+        }
+    }
+
+    while (!Active.empty())
+    {
+        for (VertexId v : Active)
+        {
+            Color[v] = v;
+        }
+
+        std::atomic<bool> Changed{ true };
+
+        while (Changed.exchange(false))
+        {
+            ParallelFor(Active.size(), ThreadCount, [&](size_t Begin, size_t End)
+            {
+                for (size_t i = Begin; i < End; ++i)
+                {
+                    const VertexId v{ Active[i] };
+                    const VertexId Mine{ std::atomic_ref<VertexId>(Color[v]).load(std::memory_order_relaxed) };
+
+                    for (VertexId w : Out.Neighbors(v))
+                    {
+                        if (Assigned(w))
+                        {
+                            continue;
+                        }
+
+                        std::atomic_ref<VertexId> Theirs(Color[w]);
+
+                        VertexId Current{ Theirs.load(std::memory_order_relaxed) };
+
+                        while ((Current < Mine) && !Theirs.compare_exchange_weak(Current, Mine, std::memory_order_relaxed))
+                        {
+                        }
+
+                        if (Current < Mine)
+                        {
+                            Changed.store(true, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }, 256);
+        }
+
+        std::vector<VertexId> Roots;
+
+        for (VertexId v : Active)
+        {
+            if (Color[v] == v)
+            {
+                Roots.push_back(v);
+            }
+        }
+
+        //
+        // Colors partition the remaining vertices, so the backward searches
+        // from different roots never meet and can run side by side.
+        //
+
+        ParallelFor(Roots.size(), ThreadCount, [&](size_t Begin, size_t End)
+        {
+            std::vector<VertexId> Queue;
+
+            for (size_t r = Begin; r < End; ++r)
+            {
+                const VertexId Root{ Roots[r] };
+                const VertexId Id{ Numbered.fetch_add(1, std::memory_order_relaxed) };
+
+                Queue.assign(1, Root);
+                Assign(Root, Id);
+
+                for (size_t Head = 0; Head < Queue.size(); ++Head)
+                {
+                    for (VertexId w : In.Neighbors(Queue[Head]))
+                    {
+                        if ((Color[w] == Root) && !Assigned(w))
+                        {
+                            Assign(w, Id);
+                            Queue.push_back(w);
+                        }
+                    }
+                }
+            }
+        }, 1);
+
+        Active.erase(std::remove_if(Active.begin(), Active.end(), Assigned), Active.end());
+    }
+
+    Result.Count = Numbered.load();
+    Result.Condensation = BuildCondensation(Out, Result.Component, Result.Count, ThreadCount);
+
+    return Result;
+}
+
+//
+// Topological order of a DAG, an edge u -> v meaning u has to come before
+// v. Level[v] is the wavefront of v: the length of the longest path that
+// ends at v, so vertices of the same level never depend on each other and
+// can run concurrently. If the graph has cycles, Order and Level only
+// cover the vertices that do not depend on one (Level is InvalidVertex
+// for the others) and Cycle holds the vertices of one cycle, in order.
+//
+
+struct TopologicalResult
+{
+    std::vector<VertexId> Order;
+    std::vector<VertexId> Level;
+    VertexId LevelCount{ 0 };
+    std::vector<VertexId> Cycle;
+};
+
+template <typename Adjacency>
+std::vector<VertexId> CountInDegrees(const Adjacency& Out, unsigned int ThreadCount)
+{
+    std::vector<VertexId> InDegree(Out.VertexCount(), 0);
+
+    ParallelFor(Out.VertexCount(), ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (size_t u = Begin; u < End; ++u)
+        {
+            for (VertexId v : Out.Neighbors(static_cast<VertexId>(u)))
+            {
+                std::atomic_ref<VertexId>(InDegree[v]).fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }, 256);
+
+    return InDegree;
+}
+
+template <typename Adjacency>
+std::vector<VertexId> FindCycle(const Adjacency& Out, const std::vector<VertexId>& Level)
+{
+    //
+    // Depth-first search, with an explicit stack, over the vertices Kahn's
+    // algorithm could not order; every one of them has a predecessor among
+    // them, so they contain a cycle, closed by the first edge back to a
+    // vertex still on the stack.
+    //
+
+    constexpr uint8_t Unseen{ 0 };
+    constexpr uint8_t OnPath{ 1 };
+    constexpr uint8_t Finished{ 2 };
+
+    using Cursor = decltype(Out.Neighbors(0).begin());
+
+    struct Frame
+    {
+        VertexId Vertex;
+        Cursor Next;
+        Cursor End;
+    };
+
+    const VertexId Count{ Out.VertexCount() };
+
+    std::vector<uint8_t> State(Count, Unseen);
+    std::vector<Frame> Frames;
+
+    auto Enter = [&](VertexId v)
+    {
+        const auto Neighbors{ Out.Neighbors(v) };
+
+        State[v] = OnPath;
+        Frames.push_back(Frame{ v, Neighbors.begin(), Neighbors.end() });
+    };
+
+    for (VertexId Root = 0; Root < Count; ++Root)
+    {
+        if ((Level[Root] != InvalidVertex) || (State[Root] != Unseen))
+        {
+            continue;
+        }
+
+        Enter(Root);
+
+        while (!Frames.empty())
+        {
+            Frame& Top{ Frames.back() };
+
+            if (Top.Next == Top.End)
+            {
+                State[Top.Vertex] = Finished;
+                Frames.pop_back();
+                continue;
+            }
+
+            const VertexId w{ *Top.Next };
+
+            ++Top.Next;
+
+            if (Level[w] != InvalidVertex)
+            {
+                continue;
+            }
+
+            if (State[w] == Unseen)
+            {
+                Enter(w);
+            }
+            else if (State[w] == OnPath)
+            {
+                std::vector<VertexId> Cycle;
+
+                auto Start{ std::find_if(Frames.begin(), Frames.end(), [w](const Frame& frame) { return frame.Vertex == w; }) };
+
+                for (; Start != Frames.end(); ++Start)
+                {
+                    Cycle.push_back(Start->Vertex);
+                }
+
+                return Cycle;
+            }
+        }
+    }
+
+    return {};
+}
+
+template <typename Adjacency>
+TopologicalResult TopologicalSort(const Adjacency& Out, unsigned int ThreadCount = 0)
+{
+    //
+    // Kahn's algorithm, one wavefront at a time: the vertices of the
+    // current level are spread over the workers, and each edge they
+    // release decrements the in-degree of its target atomically. Whoever
+    // brings it to zero appends the target to the next level.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    TopologicalResult Result;
+
+    std::vector<VertexId> InDegree{ CountInDegrees(Out, ThreadCount) };
+
+    Result.Level.assign(Count, InvalidVertex);
+    Result.Order.resize(Count);
+
+    size_t Done{ 0 };
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        if (InDegree[v] == 0)
+        {
+            Result.Level[v] = 0;
+            Result.Order[Done++] = v;
+        }
+    }
+
+    for (size_t LevelBegin = 0; LevelBegin < Done; ++Result.LevelCount)
+    {
+        const size_t LevelEnd{ Done };
+        const VertexId Next{ Result.LevelCount + 1 };
+
+        std::atomic<size_t> Size{ LevelEnd };
+
+        ParallelFor(LevelEnd - LevelBegin, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            std::vector<VertexId> Released;
+
+            for (size_t i = LevelBegin + Begin; i < LevelBegin + End; ++i)
+            {
+                for (VertexId w : Out.Neighbors(Result.Order[i]))
+                {
+                    if (std::atomic_ref<VertexId>(InDegree[w]).fetch_sub(1, std::memory_order_relaxed) == 1)
+                    {
+                        Result.Level[w] = Next;
+                        Released.push_back(w);
+                    }
+                }
+            }
+
+            std::copy(Released.begin(), Released.end(), Result.Order.begin() + static_cast<ptrdiff_t>(Size.fetch_add(Released.size(), std::memory_order_relaxed)));
+        }, 64);
+
+        LevelBegin = LevelEnd;
+        Done = Size.load();
+    }
+
+    Result.Order.resize(Done);
+
+    if (Done < Count)
+    {
+        Result.Cycle = FindCycle(Out, Result.Level);
+    }
+
+    return Result;
+}
+
+template <typename Adjacency, typename Task>
+bool RunInDependencyOrder(const Adjacency& Out, Task&& task, unsigned int ThreadCount = 0)
+{
+    //
+    // Calls Task(v) for every vertex on a pool of worker threads, each as
+    // soon as the tasks of all its predecessors have returned, so
+    // independent work overlaps instead of waiting for a whole level. A
+    // worker that releases successors keeps one to run next and queues the
+    // rest for the others. Vertices on or behind a cycle never run; the
+    // return value says whether every vertex ran.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+    const unsigned int Workers{ WorkerCount(ThreadCount) };
+
+    std::vector<VertexId> Pending{ CountInDegrees(Out, ThreadCount) };
+    std::deque<VertexId> Ready;
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        if (Pending[v] == 0)
+        {
+            Ready.push_back(v);
+        }
+    }
+
+    std::mutex Lock;
+    std::condition_variable Wake;
+
+    unsigned int Busy{ 0 };
+    std::atomic<VertexId> Ran{ 0 };
+
+    auto Worker = [&]()
+    {
+        std::unique_lock<std::mutex> Guard(Lock);
+
+        for (;;)
+        {
+            Wake.wait(Guard, [&]() { return !Ready.empty() || (Busy == 0); });
+
+            if (Ready.empty())
+            {
+                //
+                // Nothing queued and nobody running who could queue more.
+                //
+
+                Wake.notify_all();
+                return;
+            }
+
+            VertexId v{ Ready.front() };
+
+            Ready.pop_front();
+            ++Busy;
+
+            Guard.unlock();
+
+            std::vector<VertexId> Released;
+
+            while (v != InvalidVertex)
+            {
+                task(v);
+
+                Released.clear();
+
+                for (VertexId w : Out.Neighbors(v))
+                {
+                    if (std::atomic_ref<VertexId>(Pending[w]).fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    {
+                        Released.push_back(w);
+                    }
+                }
+
+                v = Released.empty() ? InvalidVertex : Released.back();
+
+                if (Released.size() > 1)
+                {
+                    Guard.lock();
+                    Ready.insert(Ready.end(), Released.begin(), Released.end() - 1);
+                    Guard.unlock();
+
+                    Wake.notify_all();
+                }
+
+                Ran.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            Guard.lock();
+            --Busy;
+
+            if (Busy == 0)
+            {
+                Wake.notify_all();
+            }
+        }
+    };
+
+    std::vector<std::thread> Threads;
+
+    for (unsigned int t = 1; t < Workers; ++t)
+    {
+        Threads.emplace_back(Worker);
+    }
+
+    Worker();
+
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    return Ran.load() == Count;
+}
+
+//
+// Betweenness centrality: for every vertex v, the sum over pairs (s, t)
+// of the fraction of the shortest s-t paths that go through v, with all
+// edges counting as 1. Exact with SampleCount 0; otherwise only that many
+// random sources are searched and the sums scaled up by VertexCount over
+// SampleCount, which is an unbiased estimate. A ThreadCount of 0 means
+// one worker per hardware thread.
+//
+
+struct BetweennessOptions
+{
+    VertexId SampleCount{ 0 };
+    uint32_t Seed{ 27491095 };
+    unsigned int ThreadCount{ 0 };
+};
+
+template <typename Adjacency>
+std::vector<double> Betweenness(const Adjacency& Out, const BetweennessOptions& Options = BetweennessOptions())
+{
+    //
+    // Brandes: a BFS from each source records the level of every vertex
+    // and the number of shortest paths that reach it, and the vertices in
+    // the order they were found. Walking that order backward, each vertex
+    // collects the dependency of the source on it from its successors, the
+    // neighbors one level further: Delta[v] is the sum over them of
+    // Paths[v] / Paths[w] * (1 + Delta[w]). Since successors are found by
+    // their level, no predecessor lists are needed.
+    //
+    // Sources are claimed one at a time from a shared cursor. Each worker
+    // keeps its own search arrays, only resets the entries the last search
+    // touched, and adds into its own accumulator; the accumulators are
+    // summed at the end.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    std::vector<VertexId> Sources(Count);
+
+    std::iota(Sources.begin(), Sources.end(), VertexId{ 0 });
+
+    double Scale{ 1 };
+
+    if (Options.SampleCount && (Options.SampleCount < Count))
+    {
+        std::mt19937 Random(Options.Seed);
+
+        for (VertexId i = 0; i < Options.SampleCount; ++i)
+        {
+            std::swap(Sources[i], Sources[std::uniform_int_distribution<VertexId>(i, Count - 1)(Random)]);
+        }
+
+        Sources.resize(Options.SampleCount);
+        Scale = static_cast<double>(Count) / Options.SampleCount;
+    }
+
+    const unsigned int Workers{ static_cast<unsigned int>(std::min<size_t>(WorkerCount(Options.ThreadCount), std::max<size_t>(Sources.size(), 1))) };
+
+    std::vector<std::vector<double>> Accumulators(Workers);
+    std::atomic<size_t> Cursor{ 0 };
+
+    auto Worker = [&](unsigned int Index)
+    {
+        std::vector<double>& Centrality{ Accumulators[Index] };
+        std::vector<VertexId> Level(Count, InvalidVertex);
+        std::vector<double> Paths(Count, 0);
+        std::vector<double> Delta(Count, 0);
+        std::vector<VertexId> Order;
+
+        Centrality.assign(Count, 0);
+        Order.reserve(Count);
+
+        for (;;)
+        {
+            const size_t Next{ Cursor.fetch_add(1, std::memory_order_relaxed) };
+
+            if (Next >= Sources.size())
+            {
+                break;
+            }
+
+            for (VertexId v : Order)
+            {
+                Level[v] = InvalidVertex;
+                Paths[v] = 0;
+                Delta[v] = 0;
+            }
+
+            Order.clear();
+
+            const VertexId Source{ Sources[Next] };
+
+            Level[Source] = 0;
+            Paths[Source] = 1;
+            Order.push_back(Source);
+
+            for (size_t Head = 0; Head < Order.size(); ++Head)
+            {
+                const VertexId v{ Order[Head] };
+
+                for (VertexId w : Out.Neighbors(v))
+                {
+                    if (Level[w] == InvalidVertex)
+                    {
+                        Level[w] = Level[v] + 1;
+                        Order.push_back(w);
+                    }
+
+                    if (Level[w] == Level[v] + 1)
+                    {
+                        Paths[w] += Paths[v];
+                    }
+                }
+            }
+
+            for (size_t i = Order.size(); i-- > 1;)
+            {
+                const VertexId v{ Order[i] };
+
+                double Dependency{ 0 };
+
+                for (VertexId w : Out.Neighbors(v))
+                {
+                    if (Level[w] == Level[v] + 1)
+                    {
+                        Dependency += (1 + Delta[w]) / Paths[w];
+                    }
+                }
+
+                Delta[v] = Paths[v] * Dependency;
+                Centrality[v] += Delta[v];
+            }
+        }
+    };
+
+    std::vector<std::thread> Threads;
+
+    for (unsigned int t = 1; t < Workers; ++t)
+    {
+        Threads.emplace_back(Worker, t);
+    }
+
+    Worker(0);
+
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    std::vector<double> Result(std::move(Accumulators[0]));
+
+    ParallelFor(Count, Options.ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (size_t v = Begin; v < End; ++v)
+        {
+            for (unsigned int t = 1; t < Workers; ++t)
+            {
+                Result[v] += Accumulators[t][v];
+            }
+
+            Result[v] *= Scale;
+        }
+    });
+
+    return Result;
+}
+
+//
+// The undirected closure of an adjacency: v is a neighbor of u whenever
+// there is an edge between them in either direction. Self-loops dropped.
+//
+
+template <typename Adjacency>
+CsrAdjacency Symmetrize(const Adjacency& Out, unsigned int ThreadCount = 0)
+{
+    std::vector<Edge> Both;
+
+    Both.reserve(2 * Out.EdgeCount());
+
+    for (VertexId u = 0; u < Out.VertexCount(); ++u)
+    {
+        for (VertexId v : Out.Neighbors(u))
+        {
+            if (u != v)
+            {
+                Both.push_back(Edge(u, v));
+                Both.push_back(Edge(v, u));
+            }
+        }
+    }
+
+    CsrAdjacency Symmetric;
+
+    Symmetric.Build(Out.VertexCount(), Both, false, {}, ThreadCount);
+
+    return Symmetric;
+}
+
+//
+// Core numbers: the core number of v is the largest k such that v belongs
+// to a subgraph in which every vertex has degree k or more. Both versions
+// expect a symmetric adjacency and ignore self-loops.
+//
+
+template <typename Adjacency>
+std::vector<VertexId> CoreNumbers(const Adjacency& Neighbors)
+{
+    //
+    // Batagelj and Zaversnik, O(V + E): keep the vertices sorted by current
+    // degree in Order, with Bin[d] the first position of degree d, and
+    // peel them in that order. Removing a vertex lowers the degree of each
+    // neighbor still above it, which moves that neighbor one bin down by
+    // swapping it with the first vertex of its bin.
+    //
+
+    const VertexId Count{ Neighbors.VertexCount() };
+
+    std::vector<VertexId> Degree(Count, 0);
+
+    VertexId MaxDegree{ 0 };
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        for (VertexId u : Neighbors.Neighbors(v))
+        {
+            Degree[v] += (u != v);
+        }
+
+        MaxDegree = std::max(MaxDegree, Degree[v]);
+    }
+
+    std::vector<VertexId> Bin(static_cast<size_t>(MaxDegree) + 1, 0);
+    std::vector<VertexId> Order(Count);
+    std::vector<VertexId> Position(Count);
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        ++Bin[Degree[v]];
+    }
+
+    for (VertexId d = 0, Start = 0; d <= MaxDegree; ++d)
+    {
+        const VertexId Size{ Bin[d] };
+
+        Bin[d] = Start;
+        Start += Size;
+    }
+
+    for (VertexId v = 0; v < Count; ++v)
+    {
+        Position[v] = Bin[Degree[v]]++;
+        Order[Position[v]] = v;
+    }
+
+    for (VertexId d = MaxDegree; d > 0; --d)
+    {
+        Bin[d] = Bin[d - 1];
+    }
+
+    if (Count)
+    {
+        Bin[0] = 0;
+    }
+
+    for (VertexId i = 0; i < Count; ++i)
+    {
+        const VertexId v{ Order[i] };
+
+        for (VertexId u : Neighbors.Neighbors(v))
+        {
+            if (Degree[u] > Degree[v])
+            {
+                const VertexId First{ Order[Bin[Degree[u]]] };
+
+                if (u != First)
+                {
+                    std::swap(Order[Position[u]], Order[Bin[Degree[u]]]);
+                    std::swap(Position[u], Position[First]);
+                }
+
+                ++Bin[Degree[u]];
+                --Degree[u];
+            }
+        }
+    }
+
+    return Degree;
+}
+
+template <typename Adjacency>
+std::vector<VertexId> ParallelCoreNumbers(const Adjacency& Neighbors, unsigned int ThreadCount = 0)
+{
+    //
+    // Level by level peeling. For k = 0, 1, ..., the vertices of degree k
+    // or less get core number k and are removed in parallel; each removal
+    // decrements the degree of the neighbors still there atomically, and
+    // whoever takes one from k + 1 down to k queues it for the next
+    // sub-round of the same level. Levels no vertex can reach are skipped.
+    //
+
+    const VertexId Count{ Neighbors.VertexCount() };
+
+    std::vector<VertexId> Degree(Count, 0);
+    std::vector<VertexId> Core(Count, InvalidVertex);
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (size_t v = Begin; v < End; ++v)
+        {
+            for (VertexId u : Neighbors.Neighbors(static_cast<VertexId>(v)))
+            {
+                Degree[v] += (u != v);
+            }
+        }
+    }, 256);
+
+    std::vector<VertexId> Active(Count);
+    std::vector<VertexId> Frontier;
+    std::vector<VertexId> Next(Count);
+
+    std::iota(Active.begin(), Active.end(), VertexId{ 0 });
+
+    auto Removed = [&Core](VertexId v)
+    {
+        return std::atomic_ref<VertexId>(Core[v]).load(std::memory_order_relaxed) != InvalidVertex;
+    };
+
+    for (VertexId k = 0; !Active.empty(); ++k)
+    {
+        k = std::max(k, Degree[*std::min_element(Active.begin(), Active.end(), [&Degree](VertexId a, VertexId b) { return Degree[a] < Degree[b]; })]);
+
+        Frontier.clear();
+
+        for (VertexId v : Active)
+        {
+            if (Degree[v] <= k)
+            {
+                Frontier.push_back(v);
+            }
+        }
+
+        while (!Frontier.empty())
+        {
+            for (VertexId v : Frontier)
+            {
+                Core[v] = k;
+            }
+
+            std::atomic<size_t> Size{ 0 };
+
+            ParallelFor(Frontier.size(), ThreadCount, [&](size_t Begin, size_t End)
+            {
+                std::vector<VertexId> Dropped;
+
+                for (size_t i = Begin; i < End; ++i)
+                {
+                    for (VertexId u : Neighbors.Neighbors(Frontier[i]))
+                    {
+                        if ((u != Frontier[i]) && !Removed(u) &&
+                            (std::atomic_ref<VertexId>(Degree[u]).fetch_sub(1, std::memory_order_relaxed) == k + 1))
+                        {
+                            Dropped.push_back(u);
+                        }
+                    }
+                }
+
+                std::copy(Dropped.begin(), Dropped.end(), Next.begin() + static_cast<ptrdiff_t>(Size.fetch_add(Dropped.size(), std::memory_order_relaxed)));
+            }, 64);
+
+            Frontier.assign(Next.begin(), Next.begin() + static_cast<ptrdiff_t>(Size.load()));
+        }
+
+        Active.erase(std::remove_if(Active.begin(), Active.end(), Removed), Active.end());
+    }
+
+    return Core;
+}
+
+//
+// Minimum spanning forest of an edge list, edges taken as undirected and
+// weighted by Weights (all 1 when empty). Ties are broken by edge index,
+// which makes the forest unique, so both versions below return the same
+// edges, ordered by weight then index.
+//
+
+struct SpanningForest
+{
+    std::vector<Edge> Edges;
+    std::vector<Weight> Weights;
+    Weight TotalWeight{ 0 };
+};
+
+inline SpanningForest CollectSpanningForest(const std::vector<Edge>& Edges, const std::vector<Weight>& Weights, const std::vector<EdgeIndex>& Chosen)
+{
+    SpanningForest Forest;
+
+    Forest.Edges.reserve(Chosen.size());
+    Forest.Weights.reserve(Chosen.size());
+
+    for (EdgeIndex e : Chosen)
+    {
+        Forest.Edges.push_back(Edges[e]);
+        Forest.Weights.push_back(Weights.empty() ? 1 : Weights[e]);
+        Forest.TotalWeight += Forest.Weights.back();
+    }
+
+    return Forest;
+}
+
+inline SpanningForest KruskalSpanningForest(VertexId Count, const std::vector<Edge>& Edges, const std::vector<Weight>& Weights, unsigned int ThreadCount = 0)
+{
+    //
+    // Sort the edge indices by weight in parallel, then add edges in that
+    // order as long as they join two different trees of a UnionFind. Stops
+    // as soon as the forest is a single tree.
+    //
+
+    std::vector<EdgeIndex> Order(Edges.size());
+
+    std::iota(Order.begin(), Order.end(), EdgeIndex{ 0 });
+
+    if (!Weights.empty())
+    {
+        ParallelSort(Order.begin(), Order.end(), [&Weights](EdgeIndex a, EdgeIndex b)
+        {
+            return (Weights[a] < Weights[b]) || ((Weights[a] == Weights[b]) && (a < b));
+        }, ThreadCount);
+    }
+
+    UnionFind Trees;
+
+    Trees.Reset(Count);
+
+    std::vector<EdgeIndex> Chosen;
+
+    for (EdgeIndex e : Order)
+    {
+        if (Count && (Chosen.size() == Count - 1u))
+        {
+            break;
+        }
+
+        if (Trees.Union(Edges[e].first, Edges[e].second))
+        {
+            Chosen.push_back(e);
+        }
+    }
+
+    return CollectSpanningForest(Edges, Weights, Chosen);
+}
+
+inline SpanningForest BoruvkaSpanningForest(VertexId Count, const std::vector<Edge>& Edges, const std::vector<Weight>& Weights, unsigned int ThreadCount = 0)
+{
+    //
+    // Every round, each component picks its lightest edge to another
+    // component with an atomic minimum over the edges still crossing
+    // components, then hooks itself to the component at the other end.
+    // Two components that picked each other's edge keep the lower id as
+    // the root; otherwise the order on edges rules out cycles. Compressing
+    // the parents contracts the components, and edges that now fall inside
+    // one are dropped for the next round. Every round at least halves the
+    // number of components that still have an edge out.
+    //
+
+    constexpr EdgeIndex NoEdge{ std::numeric_limits<EdgeIndex>::max() };
+
+    auto Lighter = [&Weights](EdgeIndex a, EdgeIndex b)
+    {
+        if (!Weights.empty() && (Weights[a] != Weights[b]))
+        {
+            return Weights[a] < Weights[b];
+        }
+
+        return a < b;
+    };
+
+    std::vector<VertexId> Parent(Count);
+    std::vector<VertexId> Target(Count);
+    std::vector<EdgeIndex> Best(Count, NoEdge);
+    std::vector<EdgeIndex> Chosen(Count ? Count - 1 : 0);
+    std::atomic<size_t> ChosenCount{ 0 };
+
+    std::iota(Parent.begin(), Parent.end(), VertexId{ 0 });
+
+    //
+    // The first round runs over all the edges, later ones over the indices
+    // that survived the previous round.
+    //
+
+    std::vector<EdgeIndex> Active;
+    std::vector<EdgeIndex> Survivors;
+    size_t ActiveCount{ Edges.size() };
+    bool All{ true };
+
+    while (ActiveCount)
+    {
+        ParallelFor(ActiveCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            auto Offer = [&](VertexId Component, EdgeIndex e)
+            {
+                std::atomic_ref<EdgeIndex> Slot(Best[Component]);
+
+                EdgeIndex Current{ Slot.load(std::memory_order_relaxed) };
+
+                while (((Current == NoEdge) || Lighter(e, Current)) &&
+                       !Slot.compare_exchange_weak(Current, e, std::memory_order_relaxed))
+                {
+                }
+            };
+
+            for (size_t i = Begin; i < End; ++i)
+            {
+                const EdgeIndex e{ All ? i : Active[i] };
+                const VertexId Component1{ Parent[Edges[e].first] };
+                const VertexId Component2{ Parent[Edges[e].second] };
+
+                if (Component1 != Component2)
+                {
+                    Offer(Component1, e);
+                    Offer(Component2, e);
+                }
+            }
+        });
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t c = Begin; c < End; ++c)
+            {
+                if (Best[c] != NoEdge)
+                {
+                    const VertexId Component1{ Parent[Edges[Best[c]].first] };
+
+                    Target[c] = (Component1 != c) ? Component1 : Parent[Edges[Best[c]].second];
+                }
+            }
+        });
+
+        ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            std::vector<EdgeIndex> Hooked;
+
+            for (size_t c = Begin; c < End; ++c)
+            {
+                if ((Best[c] != NoEdge) && ((Best[Target[c]] != Best[c]) || (c > Target[c])))
+                {
+                    std::atomic_ref<VertexId>(Parent[c]).store(Target[c], std::memory_order_relaxed);
+                    Hooked.push_back(Best[c]);
+                }
+            }
+
+            std::copy(Hooked.begin(), Hooked.end(), Chosen.begin() + static_cast<ptrdiff_t>(ChosenCount.fetch_add(Hooked.size(), std::memory_order_relaxed)));
+        });
+
+        std::fill(Best.begin(), Best.end(), NoEdge);
+
+        AfforestCompress(Parent, ThreadCount);
+
+        Survivors.resize(ActiveCount);
+
+        std::atomic<size_t> Size{ 0 };
+
+        ParallelFor(ActiveCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            std::vector<EdgeIndex> Kept;
+
+            for (size_t i = Begin; i < End; ++i)
+            {
+                const EdgeIndex e{ All ? i : Active[i] };
+
+                if (Parent[Edges[e].first] != Parent[Edges[e].second])
+                {
+                    Kept.push_back(e);
+                }
+            }
+
+            std::copy(Kept.begin(), Kept.end(), Survivors.begin() + static_cast<ptrdiff_t>(Size.fetch_add(Kept.size(), std::memory_order_relaxed)));
+        });
+
+        std::swap(Active, Survivors);
+        ActiveCount = Size.load();
+        All = false;
+    }
+
+    Chosen.resize(ChosenCount.load());
+
+    ParallelSort(Chosen.begin(), Chosen.end(), Lighter, ThreadCount);
+
+    return CollectSpanningForest(Edges, Weights, Chosen);
+}
+
+//
+// Reachability index for repeated "can u reach v" queries on a static
+// directed graph. Vertices are mapped to their strongly connected
+// component, numbered by Tarjan in reverse topological order, so a
+// component can only reach components with lower ids. Each component of
+// the condensation also gets Labels GRAIL intervals (Yildirim, Chaoji and
+// Zaki): one [Low, Post] pair per randomized DFS, Post being the postorder
+// rank and Low the lowest rank below it. If v is reachable from u, every
+// interval of v nests in the matching interval of u, so most negative
+// queries are answered in O(Labels). The rest fall back to a DFS of the
+// condensation that prunes every component whose intervals rule it out.
+//
+// Queries reuse the search scratch of the index, so one index serves one
+// thread at a time.
+//
+
+struct ReachabilityIndex
+{
+    std::vector<VertexId> Component;
+    CsrAdjacency Condensation;
+    std::vector<VertexId> Intervals;
+    unsigned int Labels{ 0 };
+    VisitedEpochs Visited;
+    std::vector<VertexId> Stack;
+
+    template <typename Adjacency>
+    void Build(const Adjacency& Out, unsigned int LabelCount = 3, uint32_t Seed = 27491095, unsigned int ThreadCount = 0)
+    {
+        SccResult Scc{ StronglyConnectedComponents(Out) };
+
+        Component = std::move(Scc.Component);
+        Condensation = std::move(Scc.Condensation);
+        Labels = std::max(LabelCount, 1u);
+        Intervals.assign(static_cast<size_t>(Scc.Count) * Labels * 2, 0);
+
+        //
+        // The traversals are independent and each fills its own slots, so
+        // they run in parallel.
+        //
+
+        ParallelFor(Labels, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t Label = Begin; Label < End; ++Label)
+            {
+                Traverse(static_cast<unsigned int>(Label), Seed + static_cast<uint32_t>(Label));
+            }
+        }, 1);
+    }
+
+    bool Reaches(VertexId From, VertexId To)
+    {
+        if ((From >= Component.size()) || (To >= Component.size()))
+        {
+            return false;
+        }
+
+        const VertexId Source{ Component[From] };
+        const VertexId Target{ Component[To] };
+
+        if (Source == Target)
+        {
+            return true;
+        }
+
+        if ((Source < Target) || !Contains(Source, Target))
+        {
+            return false;
+        }
+
+        Visited.Reset(Condensation.VertexCount());
+        Visited.Set(Source);
+        Stack.assign(1, Source);
+
+        while (!Stack.empty())
+        {
+            const VertexId c{ Stack.back() };
+
+            Stack.pop_back();
+
+            for (VertexId d : Condensation.Neighbors(c))
+            {
+                if (d == Target)
+                {
+                    return true;
+                }
+
+                if ((d > Target) && !Visited.TestAndSet(d) && Contains(d, Target))
+                {
+                    Stack.push_back(d);
+                }
+            }
+        }
+
+        return false;
+    }
+
+private:
+
+    VertexId& Low(VertexId c, unsigned int Label)
+    {
+        return Intervals[(static_cast<size_t>(c) * Labels + Label) * 2];
+    }
+
+    VertexId& Post(VertexId c, unsigned int Label)
+    {
+        return Intervals[(static_cast<size_t>(c) * Labels + Label) * 2 + 1];
+    }
+
+    bool Contains(VertexId Outer, VertexId Inner) const
+    {
+        const VertexId* OuterLabels{ &Intervals[static_cast<size_t>(Outer) * Labels * 2] };
+        const VertexId* InnerLabels{ &Intervals[static_cast<size_t>(Inner) * Labels * 2] };
+
+        for (unsigned int Label = 0; Label < Labels; ++Label)
+        {
+            if ((InnerLabels[2 * Label] < OuterLabels[2 * Label]) || (InnerLabels[2 * Label + 1] > OuterLabels[2 * Label + 1]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void Traverse(unsigned int Label, uint32_t Seed)
+    {
+        //
+        // Iterative DFS from the components in random order, visiting the
+        // children of each one from a random starting point. Post is set
+        // when a component finishes, and Low then takes the minimum over
+        // its children, which have all finished since the graph is a DAG.
+        // Post is never 0, which marks components not yet finished.
+        //
+
+        struct Frame
+        {
+            VertexId Vertex;
+            VertexId Rotation;
+            VertexId Next;
+        };
+
+        const VertexId Count{ Condensation.VertexCount() };
+
+        std::mt19937 Random(Seed);
+        std::vector<VertexId> Roots(Count);
+        std::vector<uint8_t> Started(Count, 0);
+        std::vector<Frame> Frames;
+        VertexId Rank{ 0 };
+
+        std::iota(Roots.begin(), Roots.end(), VertexId{ 0 });
+        std::shuffle(Roots.begin(), Roots.end(), Random);
+
+        auto Open = [&](VertexId c)
+        {
+            const VertexId Degree{ static_cast<VertexId>(Condensation.Degree(c)) };
+
+            Started[c] = 1;
+            Frames.push_back(Frame{ c, Degree ? static_cast<VertexId>(Random() % Degree) : 0, 0 });
+        };
+
+        for (VertexId Root : Roots)
+        {
+            if (Started[Root])
+            {
+                continue;
+            }
+
+            Open(Root);
+
+            while (!Frames.empty())
+            {
+                Frame& Top{ Frames.back() };
+                const VertexId c{ Top.Vertex };
+                const NeighborRange Children{ Condensation.Neighbors(c) };
+                const VertexId Degree{ static_cast<VertexId>(Children.end() - Children.begin()) };
+
+                if (Top.Next < Degree)
+                {
+                    const VertexId Child{ Children.begin()[(Top.Rotation + Top.Next++) % Degree] };
+
+                    if (!Started[Child])
+                    {
+                        Open(Child);
+                    }
+
+                    continue;
+                }
+
+                Frames.pop_back();
+
+                Post(c, Label) = ++Rank;
+                Low(c, Label) = Rank;
+
+                for (VertexId Child : Children)
+                {
+                    Low(c, Label) = std::min(Low(c, Label), Low(Child, Label));
+                }
+            }
+        }
+    }
+};
+
+//
+// Vertex orderings for locality. Ids follow insertion order, which scatters
+// the neighbors of a vertex all over the per-vertex arrays; relabeling so
+// that vertices used together get nearby ids turns many of the random
+// accesses of a traversal into cache hits. Every ordering returns a
+// permutation, NewIds[v] being the new id of v, to hand to Graph::Reorder()
+// or PermuteAdjacency().
+//
+
+inline std::vector<VertexId> InvertOrder(const std::vector<VertexId>& Order)
+{
+    std::vector<VertexId> NewIds(Order.size());
+
+    for (size_t i = 0; i < Order.size(); ++i)
+    {
+        NewIds[Order[i]] = static_cast<VertexId>(i);
+    }
+
+    return NewIds;
+}
+
+template <typename Adjacency>
+std::vector<VertexId> DegreeOrder(const Adjacency& Out, bool HubsOnly = true)
+{
+    //
+    // Hub sorting (Zhang et al.): the vertices of above-average degree come
+    // first, by decreasing degree, and the others keep their relative order,
+    // so the hot vertices share a few cache lines without losing whatever
+    // locality the original order had. A full sort by degree otherwise.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    std::vector<VertexId> Order(Count);
+
+    std::iota(Order.begin(), Order.end(), VertexId{ 0 });
+
+    auto ByDegree = [&Out](VertexId a, VertexId b)
+    {
+        return Out.Degree(a) > Out.Degree(b);
+    };
+
+    auto Last{ Order.end() };
+
+    if (HubsOnly && Count)
+    {
+        const EdgeIndex Average{ Out.EdgeCount() / Count };
+
+        Last = std::stable_partition(Order.begin(), Order.end(), [&Out, Average](VertexId v) { return Out.Degree(v) > Average; });
+    }
+
+    std::stable_sort(Order.begin(), Last, ByDegree);
+
+    return InvertOrder(Order);
+}
+
+template <typename Adjacency>
+std::vector<VertexId> ReverseCuthillMcKeeOrder(const Adjacency& Out)
+{
+    //
+    // Reverse Cuthill-McKee: a BFS that visits the neighbors of each vertex
+    // by increasing degree, one component at a time starting from a vertex
+    // of lowest degree, and the resulting order reversed. It narrows the
+    // bandwidth of the adjacency matrix, so neighbors get close ids. The
+    // adjacency should be symmetric; on a directed graph only the out-edges
+    // are followed.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+
+    std::vector<VertexId> Starts(Count);
+
+    std::iota(Starts.begin(), Starts.end(), VertexId{ 0 });
+
+    auto ByDegree = [&Out](VertexId a, VertexId b)
+    {
+        return Out.Degree(a) < Out.Degree(b);
+    };
+
+    std::stable_sort(Starts.begin(), Starts.end(), ByDegree);
+
+    std::vector<VertexId> Order;
+    std::vector<VertexId> Scratch;
+
+    VisitedBitmap Placed;
+
+    Order.reserve(Count);
+    Placed.Reset(Count);
+
+    for (VertexId Start : Starts)
+    {
+        if (Placed.TestAndSet(Start))
+        {
+            continue;
+        }
+
+        Order.push_back(Start);
+
+        for (size_t Head = Order.size() - 1; Head < Order.size(); ++Head)
+        {
+            Scratch.clear();
+
+            for (VertexId v : Out.Neighbors(Order[Head]))
+            {
+                if (!Placed.TestAndSet(v))
+                {
+                    Scratch.push_back(v);
+                }
+            }
+
+            std::stable_sort(Scratch.begin(), Scratch.end(), ByDegree);
+
+            Order.insert(Order.end(), Scratch.begin(), Scratch.end());
+        }
+    }
+
+    std::reverse(Order.begin(), Order.end());
+
+    return InvertOrder(Order);
+}
+
+//
+// Max-priority queue of vertices over small integer keys that only ever
+// move by one, as Gorder needs: one doubly linked list per key value, so
+// Increment(), Decrement() and Remove() are O(1) and Pop() only walks down
+// over empty buckets.
+//
+
+struct UnitHeap
+{
+    std::vector<VertexId> Head;    // Indexed by key
+    std::vector<VertexId> Prev;
+    std::vector<VertexId> Next;
+    std::vector<uint32_t> Key;
+    uint32_t Top{ 0 };
+
+    void Reset(const std::vector<VertexId>& Order)
+    {
+        //
+        // Everything starts at key 0, popping in the given order.
+        //
+
+        const size_t Count{ Order.size() };
+
+        Head.assign(1, InvalidVertex);
+        Prev.assign(Count, InvalidVertex);
+        Next.assign(Count, InvalidVertex);
+        Key.assign(Count, 0);
+        Top = 0;
+
+        for (size_t i = Count; i-- > 0; )
+        {
+            Link(Order[i]);
+        }
+    }
+
+    void Increment(VertexId Id)
+    {
+        Unlink(Id);
+        ++Key[Id];
+
+        if (Key[Id] >= Head.size())
+        {
+            Head.push_back(InvalidVertex);
+        }
+
+        Link(Id);
+
+        Top = std::max(Top, Key[Id]);
+    }
+
+    void Decrement(VertexId Id)
+    {
+        Unlink(Id);
+        --Key[Id];
+        Link(Id);
+    }
+
+    void Remove(VertexId Id)
+    {
+        Unlink(Id);
+    }
+
+    VertexId Pop()
+    {
+        while (Top && (Head[Top] == InvalidVertex))
+        {
+            --Top;
+        }
+
+        const VertexId Id{ Head[Top] };
+
+        if (Id != InvalidVertex)
+        {
+            Unlink(Id);
+        }
+
+        return Id;
+    }
+
+private:
+
+    void Link(VertexId Id)
+    {
+        VertexId& First{ Head[Key[Id]] };
+
+        Prev[Id] = InvalidVertex;
+        Next[Id] = First;
+
+        if (First != InvalidVertex)
+        {
+            Prev[First] = Id;
+        }
+
+        First = Id;
+    }
+
+    void Unlink(VertexId Id)
+    {
+        if (Prev[Id] != InvalidVertex)
+        {
+            Next[Prev[Id]] = Next[Id];
+        }
+        else
+        {
+            Head[Key[Id]] = Next[Id];
+        }
+
+        if (Next[Id] != InvalidVertex)
+        {
+            Prev[Next[Id]] = Prev[Id];
+        }
+    }
+};
+
+template <typename Adjacency>
+std::vector<VertexId> GorderOrder(const Adjacency& Out, const Adjacency& In, unsigned int Window = 5)
+{
+    //
+    // Gorder (Wei et al.): greedily place next the vertex that scores best
+    // against the last Window placed ones, where a pair scores one for each
+    // edge between them and one for each in-neighbor they share, so
+    // vertices read together during a traversal end up side by side. The
+    // scores of the unplaced vertices live in a unit heap, bumped as
+    // vertices enter the window and lowered as they leave it. As in the
+    // paper, shared in-neighbors of high degree are not expanded: they
+    // would touch most of the graph for little gain.
+    //
+
+    const VertexId Count{ Out.VertexCount() };
+    const EdgeIndex HubDegree{ static_cast<EdgeIndex>(std::sqrt(static_cast<double>(Count))) + 1 };
+
+    std::vector<VertexId> Seeds(Count);
+
+    std::iota(Seeds.begin(), Seeds.end(), VertexId{ 0 });
+
+    std::stable_sort(Seeds.begin(), Seeds.end(), [&In](VertexId a, VertexId b) { return In.Degree(a) > In.Degree(b); });
+
+    UnitHeap Scores;
+    VisitedBitmap Placed;
+    std::vector<VertexId> Order;
+
+    Scores.Reset(Seeds);
+    Placed.Reset(Count);
+    Order.reserve(Count);
+
+    auto Update = [&](VertexId x, bool Entering)
+    {
+        auto Bump = [&](VertexId w)
+        {
+            if (!Placed.Test(w))
+            {
+                if (Entering)
+                {
+                    Scores.Increment(w);
+                }
+                else
+                {
+                    Scores.Decrement(w);
+                }
+            }
+        };
+
+        for (VertexId w : Out.Neighbors(x))
+        {
+            Bump(w);
+        }
+
+        for (VertexId u : In.Neighbors(x))
+        {
+            Bump(u);
+
+            if (Out.Degree(u) <= HubDegree)
+            {
+                for (VertexId w : Out.Neighbors(u))
+                {
+                    if (w != x)
+                    {
+                        Bump(w);
+                    }
+                }
+            }
+        }
+    };
+
+    for (VertexId i = 0; i < Count; ++i)
+    {
+        const VertexId v{ Scores.Pop() };
+
+        Placed.Set(v);
+        Order.push_back(v);
+
+        Update(v, true);
+
+        if (i >= Window)
+        {
+            Update(Order[i - Window], false);
+        }
+    }
+
+    return InvertOrder(Order);
+}
+
+//
+// Mean log2 of the id gap |u - v| + 1 over all edges: the lower, the closer
+// neighbors sit in the per-vertex arrays. A portable stand-in for a cache
+// miss count, and roughly the bits a gap-encoded neighbor would take.
+//
+
+template <typename Adjacency>
+double EdgeGapScore(const Adjacency& Out)
+{
+    double Total{ 0 };
+
+    for (VertexId u = 0; u < Out.VertexCount(); ++u)
+    {
+        for (VertexId v : Out.Neighbors(u))
+        {
+            Total += std::log2(static_cast<double>((u > v) ? u - v : v - u) + 1);
+        }
+    }
+
+    return Out.EdgeCount() ? Total / static_cast<double>(Out.EdgeCount()) : 0;
+}
+
+inline CsrAdjacency PermuteAdjacency(const CsrAdjacency& Base, const std::vector<VertexId>& NewIds, unsigned int ThreadCount = 0)
+{
+    //
+    // The same adjacency with every vertex relabeled, built anew.
+    //
+
+    const VertexId Count{ Base.VertexCount() };
+
+    std::vector<Edge> Relabeled(Base.EdgeCount());
+
+    ParallelFor(Count, ThreadCount, [&](size_t Begin, size_t End)
+    {
+        for (size_t u = Begin; u < End; ++u)
+        {
+            for (EdgeIndex e = Base.Offsets[u]; e < Base.Offsets[u + 1]; ++e)
+            {
+                Relabeled[e] = Edge(NewIds[u], NewIds[Base.Targets[e]]);
+            }
+        }
+    }, 256);
+
+    CsrAdjacency Permuted;
+
+    Permuted.Build(Count, Relabeled, false, Base.Weights, ThreadCount);
+
+    return Permuted;
+}
+
+//
+// One side of a bidirectional search: the vertices it has seen, their
+// distance from its origin, and its current and next frontiers. Distance
+// is only meaningful where Seen is set, so Reset() stays O(1) between
+// queries thanks to the epoch stamps.
+//
+
+struct SearchSide
+{
+    VisitedEpochs Seen;
+    std::vector<int> Distance;
+    std::vector<VertexId> Current;
+    std::vector<VertexId> Next;
+
+    void Reset(VertexId Count, VertexId Origin)
+    {
+        Seen.Reset(Count);
+        Distance.resize(Count);
+        Current.clear();
+        Next.clear();
+
+        Seen.Set(Origin);
+        Distance[Origin] = 0;
+        Current.push_back(Origin);
+    }
+};
+
+//
+// Walk visitors are callables taking a vertex, as a VertexId or as its
+// name, and its distance from the origin, which return true to go on and
+// false to stop.
+//
+
+template <typename Visitor>
+constexpr bool IsWalkVisitor{ std::is_invocable_r_v<bool, Visitor&, std::string_view, int> || std::is_invocable_r_v<bool, Visitor&, VertexId, int> };
+
+template <typename Visitor>
+bool VisitWalkVertex(Visitor& visit, const VertexDictionary& Names, VertexId Id, int Distance)
+{
+    if constexpr (std::is_invocable_r_v<bool, Visitor&, VertexId, int>)
+    {
+        return visit(Id, Distance);
+    }
+    else
+    {
+        return visit(Names.Name(Id), Distance);
+    }
+}
+
+//
+// Bidirectional BFS: grow a ball around each end, always expanding one full
+// level of whichever frontier is smaller, and stop at the end of the level
+// where the two balls first touch. ForEachOut(u, visit) and ForEachIn(u,
+// visit) call visit(w) for the out- and in-neighbors of u. Returns -1 when
+// Target cannot be reached.
+//
+
+template <typename OutEdges, typename InEdges>
+int BidirectionalDistance(VertexId Count, VertexId Source, VertexId Target, SearchSide& Forward, SearchSide& Backward, OutEdges&& ForEachOut, InEdges&& ForEachIn)
+{
+    Forward.Reset(Count, Source);
+    Backward.Reset(Count, Target);
+
+    int Best{ -1 };
+
+    auto Expand = [&Best](SearchSide& Near, SearchSide& Far, auto& ForEach)
+    {
+        for (VertexId u : Near.Current)
+        {
+            ForEach(u, [&](VertexId w)
+            {
+                if (Near.Seen.TestAndSet(w))
+                {
+                    return;
+                }
+
+                Near.Distance[w] = Near.Distance[u] + 1;
+                Near.Next.push_back(w);
+
+                if (Far.Seen.Test(w))
+                {
+                    const int Length{ Near.Distance[w] + Far.Distance[w] };
+
+                    if ((Best < 0) || (Length < Best))
+                    {
+                        Best = Length;
+                    }
+                }
+            });
+        }
+
+        std::swap(Near.Current, Near.Next);
+        Near.Next.clear();
+    };
+
+    while (!Forward.Current.empty() && !Backward.Current.empty())
+    {
+        if (Forward.Current.size() <= Backward.Current.size())
+        {
+            Expand(Forward, Backward, ForEachOut);
+        }
+        else
+        {
+            Expand(Backward, Forward, ForEachIn);
+        }
+
+        if (Best >= 0)
+        {
+            return Best;
+        }
+    }
+
+    return -1; // No path was found
+}
+
+//
+// Bounded cache of ShortestDistance() results, keyed on the (source,
+// target) id pair and split in ShardCount shards by source, each with its
+// own lock and LRU list, so concurrent readers rarely contend. Every
+// entry belongs to a graph version; a shard that sees a newer version
+// drops everything it holds. Capacity is the number of pairs kept per
+// shard; 0 turns the cache off.
+//
+// Optionally, once a source has been missed HotSourceMisses times, the
+// miss runs a full O(V + E) BFS from it and its whole distance array is
+// cached, answering any target in O(1). That is off by default (0): the
+// arrays cost VertexCount * sizeof(int) bytes each, and up to
+// ShardCount * SourcesPerShard of them are kept, 12.8 GB with the default
+// of 2 per shard on a 100M vertex graph.
+//
+
+struct DistanceCache
+{
+    static constexpr unsigned int ShardCount{ 16 };
+    static constexpr uint32_t None{ std::numeric_limits<uint32_t>::max() };
+
+    struct Entry
+    {
+        uint64_t Key;
+        int Distance;
+        uint32_t Prev;
+        uint32_t Next;
+    };
+
+    struct Shard
+    {
+        std::mutex Lock;
+        uint64_t Version{ 0 };
+        std::unordered_map<uint64_t, uint32_t> Slots;
+        std::vector<Entry> Entries;
+        uint32_t Newest{ None };
+        uint32_t Oldest{ None };
+        std::unordered_map<VertexId, unsigned int> Misses;
+        std::vector<std::pair<VertexId, std::vector<int>>> Sources;
+
+        void Reset(uint64_t NewVersion)
+        {
+            Version = NewVersion;
+            Slots.clear();
+            Entries.clear();
+            Newest = None;
+            Oldest = None;
+            Misses.clear();
+            Sources.clear();
+        }
+
+        void Unlink(uint32_t Slot)
+        {
+            const Entry& Item{ Entries[Slot] };
+
+            (Item.Prev == None ? Newest : Entries[Item.Prev].Next) = Item.Next;
+            (Item.Next == None ? Oldest : Entries[Item.Next].Prev) = Item.Prev;
+        }
+
+        void PushFront(uint32_t Slot)
+        {
+            Entries[Slot].Prev = None;
+            Entries[Slot].Next = Newest;
+            (Newest == None ? Oldest : Entries[Newest].Prev) = Slot;
+            Newest = Slot;
+        }
+    };
+
+    size_t Capacity{ 4096 };
+    unsigned int HotSourceMisses{ 0 };
+    size_t SourcesPerShard{ 2 };
+    Shard Shards[ShardCount];
+
+    DistanceCache() = default;
+
+    //
+    // The shard locks cannot be copied, so a copy (or a move, which falls
+    // back on it) takes the settings and starts out empty.
+    //
+
+    DistanceCache(const DistanceCache& Other) :
+        Capacity(Other.Capacity),
+        HotSourceMisses(Other.HotSourceMisses),
+        SourcesPerShard(Other.SourcesPerShard)
+    {
+    }
+
+    DistanceCache& operator=(const DistanceCache& Other)
+    {
+        if (this != &Other)
+        {
+            Capacity = Other.Capacity;
+            HotSourceMisses = Other.HotSourceMisses;
+            SourcesPerShard = Other.SourcesPerShard;
+
+            Clear();
+        }
+
+        return *this;
+    }
+
+    void Clear()
+    {
+        for (Shard& Part : Shards)
+        {
+            std::lock_guard<std::mutex> Guard(Part.Lock);
+
+            Part.Reset(0);
+        }
+    }
+
+    //
+    // Looks the pair up, from the source's distance array if it has one.
+    // On a miss, Hot tells whether the source has now been missed often
+    // enough to be worth a distance array of its own.
+    //
+
+    bool Lookup(uint64_t Version, VertexId Source, VertexId Target, int& Distance, bool& Hot)
+    {
+        Hot = false;
+
+        if (!Capacity)
+        {
+            return false;
+        }
+
+        Shard& Part{ ShardOf(Source) };
+
+        std::lock_guard<std::mutex> Guard(Part.Lock);
+
+        if (Part.Version != Version)
+        {
+            Part.Reset(Version);
+        }
+
+        for (const auto& [Origin, Distances] : Part.Sources)
+        {
+            if ((Origin == Source) && (Target < Distances.size()))
+            {
+                Distance = Distances[Target];
+
+                return true;
+            }
+        }
+
+        const auto Found{ Part.Slots.find(Key(Source, Target)) };
+
+        if (Found != Part.Slots.end())
+        {
+            Part.Unlink(Found->second);
+            Part.PushFront(Found->second);
+
+            Distance = Part.Entries[Found->second].Distance;
+
+            return true;
+        }
+
+        if (HotSourceMisses)
+        {
+            if (Part.Misses.size() >= Capacity)
+            {
+                Part.Misses.clear();
+            }
+
+            if (++Part.Misses[Source] >= HotSourceMisses)
+            {
+                Part.Misses.erase(Source);
+                Hot = true;
+            }
+        }
+
+        return false;
+    }
+
+    void Store(uint64_t Version, VertexId Source, VertexId Target, int Distance)
+    {
+        if (!Capacity)
+        {
+            return;
+        }
+
+        Shard& Part{ ShardOf(Source) };
+
+        std::lock_guard<std::mutex> Guard(Part.Lock);
+
+        if (Part.Version != Version)
+        {
+            Part.Reset(Version);
+        }
+
+        const uint64_t PairKey{ Key(Source, Target) };
+
+        if (Part.Slots.count(PairKey))
+        {
+            return;
+        }
+
+        uint32_t Slot;
+
+        if (Part.Entries.size() < Capacity)
+        {
+            Slot = static_cast<uint32_t>(Part.Entries.size());
+            Part.Entries.push_back(Entry{});
+        }
+        else
+        {
+            Slot = Part.Oldest;
+            Part.Unlink(Slot);
+            Part.Slots.erase(Part.Entries[Slot].Key);
+        }
+
+        Part.Entries[Slot].Key = PairKey;
+        Part.Entries[Slot].Distance = Distance;
+        Part.PushFront(Slot);
+        Part.Slots.emplace(PairKey, Slot);
+    }
+
+    void StoreSource(uint64_t Version, VertexId Source, std::vector<int>&& Distances)
+    {
+        if (!Capacity || !SourcesPerShard)
+        {
+            return;
+        }
+
+        Shard& Part{ ShardOf(Source) };
+
+        std::lock_guard<std::mutex> Guard(Part.Lock);
+
+        if (Part.Version != Version)
+        {
+            Part.Reset(Version);
+        }
+
+        //
+        // The arrays are few, so they are kept newest first and the last one
+        // is dropped when a new one comes in.
+        //
+
+        if (Part.Sources.size() >= SourcesPerShard)
+        {
+            Part.Sources.pop_back();
+        }
+
+        Part.Sources.emplace(Part.Sources.begin(), Source, std::move(Distances));
+    }
+
+private:
+
+    static uint64_t Key(VertexId Source, VertexId Target)
+    {
+        return (static_cast<uint64_t>(Source) << 32) | Target;
+    }
+
+    Shard& ShardOf(VertexId Source)
+    {
+        return Shards[((Source * 0x9e3779b1u) >> 16) % ShardCount];
+    }
+};
+
+//
+// Read-only memory mapping of a whole file. Empty files map to a null
+// Data with a zero Size.
+//
+
+struct MappedFile
+{
+    const char* Data{ nullptr };
+    size_t Size{ 0 };
+
+#ifdef _WIN32
+    HANDLE File{ INVALID_HANDLE_VALUE };
+    HANDLE Mapping{ nullptr };
+#else
+    int File{ -1 };
+#endif
+
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    bool Open(const char* Path)
+    {
+        Close();
+
+#ifdef _WIN32
+        File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (File == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        LARGE_INTEGER FileSize;
+
+        if (!GetFileSizeEx(File, &FileSize))
+        {
+            Close();
+
+            return false;
+        }
+
+        Size = static_cast<size_t>(FileSize.QuadPart);
+
+        if (Size == 0)
+        {
+            return true;
+        }
+
+        Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (Mapping == nullptr)
+        {
+            Close();
+
+            return false;
+        }
+
+        Data = static_cast<const char*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        File = open(Path, O_RDONLY);
+
+        if (File < 0)
+        {
+            return false;
+        }
+
+        struct stat Status;
+
+        if (fstat(File, &Status) != 0)
+        {
+            Close();
+
+            return false;
+        }
+
+        Size = static_cast<size_t>(Status.st_size);
+
+        if (Size == 0)
+        {
+            return true;
+        }
+
+        void* View{ mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File, 0) };
+
+        Data = (View == MAP_FAILED) ? nullptr : static_cast<const char*>(View);
+#endif
+
+        if (Data == nullptr)
+        {
+            Close();
+
+            return false;
+        }
+
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (Data != nullptr)
+        {
+            UnmapViewOfFile(Data);
+        }
+
+        if (Mapping != nullptr)
+        {
+            CloseHandle(Mapping);
+        }
+
+        if (File != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(File);
+        }
+
+        Mapping = nullptr;
+        File = INVALID_HANDLE_VALUE;
+#else
+        if (Data != nullptr)
+        {
+            munmap(const_cast<char*>(Data), Size);
+        }
+
+        if (File >= 0)
+        {
+            close(File);
+        }
+
+        File = -1;
+#endif
+
+        Data = nullptr;
+        Size = 0;
+    }
+};
+
+//
+// Edges parsed out of one chunk of an edge list file. Names point into the
+// mapped file and are only filled for string ids; Weights is only filled
+// when some line of the chunk has a third column.
+//
+
+struct ParsedChunk
+{
+    std::vector<Edge> Edges;
+    std::vector<std::pair<std::string_view, std::string_view>> Names;
+    std::vector<Weight> Weights;
+
+    VertexId MaxId{ 0 };
+    bool Malformed{ false };
+
+    static bool IsBlank(char c)
+    {
+        return (c == ' ') || (c == '\t') || (c == '\r');
+    }
+
+    static bool ParseId(std::string_view Token, VertexId& Id)
+    {
+        //
+        // Hand-rolled decimal parse: no locale, no exceptions, no checks
+        // beyond what an edge list needs.
+        //
+
+        uint64_t Value{ 0 };
+
+        if (Token.empty() || (Token.size() > 10))
+        {
+            return false;
+        }
+
+        for (char c : Token)
+        {
+            if ((c < '0') || (c > '9'))
+            {
+                return false;
+            }
+
+            Value = Value * 10 + static_cast<uint64_t>(c - '0');
+        }
+
+        if (Value >= InvalidVertex)
+        {
+            return false;
+        }
+
+        Id = static_cast<VertexId>(Value);
+
+        return true;
+    }
+
+    void Parse(const char* Begin, const char* End, bool IntegerIds)
+    {
+        //
+        // One edge per line: "from to [weight]", blank separated. Empty
+        // lines and lines starting with '#' or '%' are skipped.
+        //
+
+        const char* Line{ Begin };
+
+        while (Line < End)
+        {
+            const char* LineEnd{ static_cast<const char*>(memchr(Line, '\n', static_cast<size_t>(End - Line))) };
+
+            if (LineEnd == nullptr)
+            {
+                LineEnd = End;
+            }
+
+            std::string_view Tokens[3];
+            size_t TokenCount{ 0 };
+
+            for (const char* p = Line; p < LineEnd; )
+            {
+                if (IsBlank(*p))
+                {
+                    ++p;
+                    continue;
+                }
+
+                const char* Start{ p };
+
+                while ((p < LineEnd) && !IsBlank(*p))
+                {
+                    ++p;
+                }
+
+                if (TokenCount == 3)
+                {
+                    TokenCount = 4;
+                    break;
+                }
+
+                Tokens[TokenCount++] = std::string_view(Start, static_cast<size_t>(p - Start));
+            }
+
+            Line = LineEnd + 1;
+
+            if ((TokenCount == 0) || (Tokens[0][0] == '#') || (Tokens[0][0] == '%'))
+            {
+                continue;
+            }
+
+            if ((TokenCount < 2) || (TokenCount > 3))
+            {
+                Malformed = true;
+                continue;
+            }
+
+            if (IntegerIds)
+            {
+                VertexId From;
+                VertexId To;
+
+                if (!ParseId(Tokens[0], From) || !ParseId(Tokens[1], To))
+                {
+                    Malformed = true;
+                    continue;
+                }
+
+                Edges.push_back(Edge(From, To));
+                MaxId = std::max({ MaxId, From, To });
+            }
+            else
+            {
+                Names.emplace_back(Tokens[0], Tokens[1]);
+            }
+
+            const size_t Count{ IntegerIds ? Edges.size() : Names.size() };
+
+            if (TokenCount == 3)
+            {
+                Weight Cost{ 1 };
+
+                const std::from_chars_result Result{ std::from_chars(Tokens[2].data(), Tokens[2].data() + Tokens[2].size(), Cost) };
+
+                if (Result.ec != std::errc())
+                {
+                    Malformed = true;
+                }
+
+                Weights.resize(Count - 1, 1);
+                Weights.push_back(Cost);
+            }
+            else if (!Weights.empty())
+            {
+                Weights.push_back(1);
+            }
+        }
+    }
+};
+
+//
+// Binary graph snapshot: this header, then the out-edge CSR (Offsets as
+// uint64, Targets as uint32, padded to 8 bytes), the weights if any, and
+// the vertex names as uint64 offsets into a block of characters.
+//
+
+struct SnapshotHeader
+{
+    static constexpr char ExpectedMagic[8]{ 'G', 'R', 'A', 'P', 'H', 'S', 'N', 'P' };
+    static constexpr uint32_t CurrentVersion{ 1 };
+    static constexpr uint32_t WeightedFlag{ 1 };
+    static constexpr uint32_t DirectedFlag{ 2 };
+
+    char Magic[8];
+    uint32_t Version;
+    uint32_t Flags;
+    uint64_t VertexCount;
+    uint64_t EdgeCount;
+    uint64_t NameBytes;
+};
+
+//
+// Per-query state for FrozenGraph. Each thread keeps a pool of them, so a
+// query borrows one on entry and gives it back on exit without locking; a
+// thread only grows a second one when a visitor starts a nested query.
+// The visited marks are epoch stamps, so borrowing stays O(1) no matter how
+// large the last graph was.
+//
+
+struct QueryScratch
+{
+    VisitedEpochs Visited;
+    SearchSide Forward;
+    SearchSide Backward;
+    std::vector<std::pair<VertexId, int>> Queue;
+    std::vector<std::pair<VertexId, const VertexId*>> Stack;
+};
+
+struct QueryScratchLease
+{
+    std::unique_ptr<QueryScratch> Scratch;
+
+    QueryScratchLease()
+    {
+        std::vector<std::unique_ptr<QueryScratch>>& Pool{ FreeList() };
+
+        if (Pool.empty())
+        {
+            Scratch = std::make_unique<QueryScratch>();
+        }
+        else
+        {
+            Scratch = std::move(Pool.back());
+            Pool.pop_back();
+        }
+    }
+
+    ~QueryScratchLease()
+    {
+        FreeList().push_back(std::move(Scratch));
+    }
+
+    QueryScratchLease(const QueryScratchLease&) = delete;
+    QueryScratchLease& operator=(const QueryScratchLease&) = delete;
+
+    QueryScratch* operator->() const
+    {
+        return Scratch.get();
+    }
+
+    static std::vector<std::unique_ptr<QueryScratch>>& FreeList()
+    {
+        static thread_local std::vector<std::unique_ptr<QueryScratch>> Pool;
+
+        return Pool;
+    }
+};
+
+//
+// Immutable copy of a graph, made by Graph::Freeze(), that any number of
+// threads can query at once: the adjacency is compacted into CSRs up front
+// and never changes, and all the per-query state comes from the calling
+// thread's QueryScratch pool. Only the distance cache is shared, and it
+// locks per shard. Walks take the same visitors as the Graph walks.
+//
+
+struct FrozenGraph
+{
+    VertexDictionary Names;
+    CsrAdjacency Out;
+    CsrAdjacency In;
+    bool Directed{ false };
+    uint64_t Version{ 0 };
+
+    mutable DistanceCache CachedDistances;
+
+    VertexId VertexCount() const
+    {
+        return Names.Count();
+    }
+
+    VertexId FindVertex(std::string_view Name) const
+    {
+        return Names.Find(Name);
+    }
+
+    std::string_view VertexName(VertexId Id) const
+    {
+        return Names.Name(Id);
+    }
+
+    template <typename Visitor> requires IsWalkVisitor<Visitor>
+    bool DfsWalk(std::string_view Name, unsigned int* ComponentSize, Visitor&& visit) const
+    {
+        //
+        // Iterative, with one (vertex, next neighbor) frame per level so the
+        // depth of a vertex is its frame's index, in the same order as the
+        // recursive Graph::DfsWalk on a compacted graph.
+        //
+
+        if (ComponentSize)
+        {
+            (*ComponentSize) = 0;
+        }
+
+        const VertexId Id{ FindVertex(Name) };
+
+        if (Id == InvalidVertex)
+        {
+            return false;
+        }
+
+        QueryScratchLease Scratch;
+
+        VisitedEpochs& Visited{ Scratch->Visited };
+        auto& Stack{ Scratch->Stack };
+
+        Visited.Reset(VertexCount());
+        Stack.clear();
+
+        auto Enter = [&](VertexId v)
+        {
+            if (Visited.TestAndSet(v))
+            {
+                return;
+            }
+
+            if (ComponentSize)
+            {
+                ++(*ComponentSize);
+            }
+
+            if (VisitWalkVertex(visit, Names, v, static_cast<int>(Stack.size())))
+            {
+                Stack.emplace_back(v, Out.Begin(v));
+            }
+        };
+
+        Enter(Id);
+
+        while (!Stack.empty())
+        {
+            auto& [Here, Next]{ Stack.back() };
+
+            if (Next == Out.End(Here))
+            {
+                Stack.pop_back();
+            }
+            else
+            {
+                Enter(*Next++);
+            }
+        }
+
+        return true;
+    }
+
+    template <typename Visitor> requires IsWalkVisitor<Visitor>
+    bool BfsWalk(std::string_view Name, unsigned int* ComponentSize, Visitor&& visit) const
+    {
+        if (ComponentSize)
+        {
+            (*ComponentSize) = 0;
+        }
+
+        const VertexId Id{ FindVertex(Name) };
+
+        if (Id == InvalidVertex)
+        {
+            return false;
+        }
+
+        QueryScratchLease Scratch;
+
+        VisitedEpochs& Visited{ Scratch->Visited };
+        auto& Queue{ Scratch->Queue };
+
+        Visited.Reset(VertexCount());
+        Visited.Set(Id);
+        Queue.assign(1, { Id, 0 });
+
+        for (size_t Head = 0; Head < Queue.size(); ++Head)
+        {
+            const auto [Here, Distance]{ Queue[Head] };
+
+            if (ComponentSize)
+            {
+                ++(*ComponentSize);
+            }
+
+            if (!VisitWalkVertex(visit, Names, Here, Distance))
+            {
+                break;
+            }
+
+            for (VertexId Neighbor : Out.Neighbors(Here))
+            {
+                if (!Visited.TestAndSet(Neighbor))
+                {
+                    Queue.emplace_back(Neighbor, Distance + 1);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    int ShortestDistance(std::string_view From, std::string_view To) const
+    {
+        if (From == To)
+        {
+            return 0;
+        }
+
+        const VertexId Source{ FindVertex(From) };
+        const VertexId Target{ FindVertex(To) };
+
+        if ((Source == InvalidVertex) || (Target == InvalidVertex))
+        {
+            return -1;
+        }
+
+        if (Source == Target)
+        {
+            return 0;
+        }
+
+        int Distance;
+        bool Hot;
+
+        if (CachedDistances.Lookup(Version, Source, Target, Distance, Hot))
+        {
+            return Distance;
+        }
+
+        if (Hot)
+        {
+            std::vector<int> FromSource{ ::DirectionOptimizingBfs(Out, Directed ? In : Out, Source).Distances };
+
+            Distance = FromSource[Target];
+            CachedDistances.StoreSource(Version, Source, std::move(FromSource));
+
+            return Distance;
+        }
+
+        QueryScratchLease Scratch;
+
+        const CsrAdjacency& Reverse{ Directed ? In : Out };
+
+        Distance = ::BidirectionalDistance(VertexCount(), Source, Target, Scratch->Forward, Scratch->Backward,
+            [this](VertexId u, auto&& visit) { for (VertexId w : Out.Neighbors(u)) { visit(w); } },
+            [&Reverse](VertexId u, auto&& visit) { for (VertexId w : Reverse.Neighbors(u)) { visit(w); } });
+
+        CachedDistances.Store(Version, Source, Target, Distance);
+
+        return Distance;
+    }
+};
+
+//
+// The slot a Graph publishes its frozen copy through. The atomic cannot be
+// copied, and a graph that was just copied or moved into has published
+// nothing yet, so a copy starts with the slot empty and an assignment
+// empties it.
+//
+
+struct PublishedGraph
+{
+    std::atomic<std::shared_ptr<const FrozenGraph>> Snapshot;
+
+    PublishedGraph() = default;
+
+    PublishedGraph(const PublishedGraph&)
+    {
+    }
+
+    PublishedGraph& operator=(const PublishedGraph&)
+    {
+        Snapshot.store(nullptr);
+
+        return *this;
+    }
+};
+
+struct Graph
+{
+    VertexDictionary Names;
+    std::vector<Edge> Edges;
+
+    //
+    // Parallel to Edges once the first edge with a weight other than 1 is
+    // added, empty until then.
+    //
+
+    std::vector<Weight> EdgeWeights;
+
+    //
+    // Out-edges as a CSR plus the edges added since it was built. The
+    // in-edges (transpose) are only needed by some algorithms and get built
+    // on first use; after that they are maintained the same way.
+    //
+    // Dirty means the CSR has to be built from scratch, which is only the
+    // case until the first query. InDirty is the same for the transpose.
+    //
+
+    CsrAdjacency Out;
+    CsrAdjacency In;
+    DeltaAdjacency OutDelta;
+    DeltaAdjacency InDelta;
+
+    //
+    // Queries read the delta on the fly; once it grows past 1/CompactionRatio
+    // of the CSR it gets merged in. A ratio of 0 leaves merging to the bulk
+    // algorithms, which always compact first.
+    //
+
+    unsigned int CompactionRatio{ 8 };
+
+    VisitedEpochs Visited;
+    SearchSide Forward;
+    SearchSide Backward;
+    DijkstraState Dijkstra;
+
+    //
+    // Version changes with every edit to the edges, which retires whatever
+    // CachedDistances holds from before.
+    //
+
+    DistanceCache CachedDistances;
+    uint64_t Version{ 1 };
+
+    //
+    // The frozen copy readers get from Current(). Publish() replaces it
+    // atomically, so readers keep whatever copy they hold until they let go
+    // of it, and the old one goes away with its last reader. A copy of the
+    // graph starts with nothing published.
+    //
+
+    PublishedGraph Published;
+
+    bool Dirty{ false };
+    bool InDirty{ false };
+    bool Directed{ false };
+
+    void Clear()
+    {
+        Names.Clear();
+        Edges.clear();
+        EdgeWeights.clear();
+        Out.Clear();
+        In.Clear();
+        OutDelta.Clear();
+        InDelta.Clear();
+        Visited = VisitedEpochs();
+        Forward = SearchSide();
+        Backward = SearchSide();
+        Dijkstra = DijkstraState();
+        CachedDistances.Clear();
+        ++Version;
+
+        Dirty = false;
+        InDirty = false;
+        Directed = false;
+    }
+
+    VertexId VertexCount() const
+    {
+        return Names.Count();
+    }
+
+    VertexId FindVertex(std::string_view Name) const
+    {
+        return Names.Find(Name);
+    }
+
+    std::string_view VertexName(VertexId Id) const
+    {
+        return Names.Name(Id);
+    }
+
+    VertexId AddVertex(std::string_view Name)
+    {
+        return Names.Intern(Name);
+    }
+
+    void AddEdge(std::string_view first, std::string_view second, Weight Cost = 1)
+    {
+        const VertexId From{ AddVertex(first) };
+        const VertexId To{ AddVertex(second) };
+
+        if (!EdgeWeights.empty() || (Cost != 1))
+        {
+            //
+            // The first weighted edge backfills a weight of 1 for all the
+            // edges added before it.
+            //
+
+            EdgeWeights.resize(Edges.size(), 1);
+            EdgeWeights.push_back(Cost);
+        }
+
+        Edges.push_back(Edge(From, To));
+        ++Version;
+
+        //
+        // Once the adjacency exists, keep it current incrementally instead
+        // of rebuilding it.
+        //
+
+        if (Dirty || Out.Offsets.empty())
+        {
+            Dirty = true;
+        }
+        else
+        {
+            OutDelta.Insert(Out, From, To, Cost);
+        }
+
+        if (InDirty || In.Offsets.empty())
+        {
+            InDirty = true;
+        }
+        else
+        {
+            InDelta.Insert(In, To, From, Cost);
+        }
+    }
+
+    void AddDirectedEdge(std::string_view first, std::string_view second, Weight Cost = 1)
+    {
+        AddEdge(first, second, Cost);
+
+        Directed = true;
+    }
+
+    void AddUndirectedEdge(std::string_view first, std::string_view second, Weight Cost = 1)
+    {
+        AddEdge(first, second, Cost);
+        AddEdge(second, first, Cost);
+    }
+
+    template <typename Visit>
+    void ForEachNeighbor(VertexId Id, Visit&& visit) const
+    {
+        ForEachEdge(Out, OutDelta, Id, [&visit](VertexId Neighbor, Weight) { visit(Neighbor); });
+    }
+
+    void BuildAdjacencyList()
+    {
+        Out.Build(VertexCount(), Edges, false, EdgeWeights);
+        OutDelta.Clear();
+
+        Dirty = false;
+    }
+
+    bool NeedsCompaction(const CsrAdjacency& Base, const DeltaAdjacency& Delta) const
+    {
+        return CompactionRatio && (Delta.Count > (Base.EdgeCount() / CompactionRatio) + 1024);
+    }
+
+    void UpdateAdjacency(bool Compact)
+    {
+        //
+        // Queries are fine with a small delta next to the CSR; the bulk
+        // algorithms read the CSR arrays directly and ask for a compact one.
+        //
+
+        if (Dirty || Out.Offsets.empty())
+        {
+            BuildAdjacencyList();
+        }
+        else if (NeedsCompaction(Out, OutDelta) ||
+                 (Compact && (!OutDelta.Empty() || (Out.VertexCount() != VertexCount()))))
+        {
+            OutDelta.MergeInto(Out, VertexCount());
+        }
+    }
+
+    void UpdateInAdjacency(bool Compact)
+    {
+        if (InDirty || In.Offsets.empty())
+        {
+            In.Build(VertexCount(), Edges, true, EdgeWeights);
+            InDelta.Clear();
+
+            InDirty = false;
+        }
+        else if (NeedsCompaction(In, InDelta) ||
+                 (Compact && (!InDelta.Empty() || (In.VertexCount() != VertexCount()))))
+        {
+            InDelta.MergeInto(In, VertexCount());
+        }
+    }
+
+    const CsrAdjacency& InEdges()
+    {
+        UpdateInAdjacency(true);
+
+        return In;
+    }
+
+    void PreWalk()
+    {
+        UpdateAdjacency(false);
+
+        Visited.Reset(VertexCount());
+    }
+
+    void PreScan()
+    {
+        UpdateAdjacency(true);
+    }
+
+    typedef bool (*WalkCallback)(std::string_view Name, [[maybe_unused]] int Distance, [[maybe_unused]] void* Context);
+
+    //
+    // The walks take any callable as their visitor (see IsWalkVisitor),
+    // which returns false to stop, as a WalkCallback does. Visitors taking
+    // a VertexId get ids instead of names and skip the name lookup. Being
+    // template arguments, they inline into the walk loops; the WalkCallback
+    // overloads are thin adapters on top.
+    //
+    // Neighbors are followed in VertexId order, which is the order in which
+    // the vertices were first added, not in name order: the walks read the
+    // adjacency as it is stored rather than sorting every neighbor list by
+    // name on the way.
+    //
+
+    auto CallbackVisitor(WalkCallback Callback, void* Context)
+    {
+        return [this, Callback, Context](VertexId Id, int Distance)
+        {
+            return !Callback || Callback(VertexName(Id), Distance, Context);
+        };
+    }
+
+    template <typename Visitor> requires IsWalkVisitor<Visitor>
+    bool DfsWalkWorker(VertexId Id, unsigned int* ComponentSize, Visitor&& visit, int Distance = 0)
+    {
+        if (Visited.TestAndSet(Id))
+        {
+            return false;
+        }
+
+        if (ComponentSize)
+        {
+            ++(*ComponentSize);
+        }
+
+        if (!VisitWalkVertex(visit, Names, Id, Distance))
+        {
+            return true;
+        }
+
+        ForEachNeighbor(Id, [&](VertexId neighbor)
+        {
+            DfsWalkWorker(neighbor, ComponentSize, visit, Distance + 1);
+        });
+
+        return true;
+    }
+
+    bool DfsWalkWorker(VertexId Id, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, int Distance = 0, void* Context = nullptr)
+    {
+        return DfsWalkWorker(Id, ComponentSize, CallbackVisitor(Callback, Context), Distance);
+    }
+
+    template <typename Visitor> requires IsWalkVisitor<Visitor>
+    bool DfsWalk(std::string_view Name, unsigned int* ComponentSize, Visitor&& visit)
+    {
+        PreWalk();
+
+        if (ComponentSize)
+        {
+            (*ComponentSize) = 0;
+        }
+
+        const VertexId Id{ FindVertex(Name) };
+
+        if (Id == InvalidVertex)
+        {
+            return false;
+        }
+
+        return DfsWalkWorker(Id, ComponentSize, visit);
+    }
+
+    bool DfsWalk(std::string_view Name, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, void* Context = nullptr)
+    {
+        return DfsWalk(Name, ComponentSize, CallbackVisitor(Callback, Context));
+    }
+
+    template <typename Visitor> requires IsWalkVisitor<Visitor>
+    bool BfsWalkWorker(VertexId Id, unsigned int* ComponentSize, Visitor&& visit, int Distance = 0)
+    {
+        if (Visited.TestAndSet(Id))
+        {
+            return false;
+        }
+
+        using Entry = std::pair<VertexId, int>; // <Vertex, DistanceFromOrigin>
+
+        std::deque<Entry> Queue;
+
+        Queue.push_back(Entry(Id, Distance));
+
+        while (Queue.size())
+        {
+            auto entry{ Queue.front() };
+
+            Queue.pop_front();
+
+            if (ComponentSize)
+            {
+                ++(*ComponentSize);
+            }
+
+            if (!VisitWalkVertex(visit, Names, entry.first, entry.second))
+            {
+                break;
+            }
+
+            ForEachNeighbor(entry.first, [&](VertexId neighbor)
+            {
+                if (!Visited.TestAndSet(neighbor))
+                {
+                    Queue.push_back(Entry(neighbor, entry.second + 1));
+                }
+            });
+        }
+
+        return true;
+    }
+
+    bool BfsWalkWorker(VertexId Id, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, int Distance = 0, void* Context = nullptr)
+    {
+        return BfsWalkWorker(Id, ComponentSize, CallbackVisitor(Callback, Context), Distance);
+    }
+
+    template <typename Visitor> requires IsWalkVisitor<Visitor>
+    bool BfsWalk(std::string_view Name, unsigned int* ComponentSize, Visitor&& visit)
+    {
+        PreWalk();
+
+        if (ComponentSize)
+        {
+            (*ComponentSize) = 0;
+        }
+
+        const VertexId Id{ FindVertex(Name) };
+
+        if (Id == InvalidVertex)
+        {
+            return false;
+        }
+
+        return BfsWalkWorker(Id, ComponentSize, visit);
+    }
+
+    bool BfsWalk(std::string_view Name, unsigned int* ComponentSize = nullptr, WalkCallback Callback = nullptr, void* Context = nullptr)
+    {
+        return BfsWalk(Name, ComponentSize, CallbackVisitor(Callback, Context));
+    }
+
+    BfsResult DirectionOptimizingBfs(std::string_view Name, const BfsTuning& Tuning = BfsTuning())
+    {
+        PreScan();
+
+        return ::DirectionOptimizingBfs(Out, Directed ? InEdges() : Out, FindVertex(Name), Tuning);
+    }
+
+    BfsResult ParallelBfs(std::string_view Name, unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        return ::ParallelBfs(Out, FindVertex(Name), ThreadCount);
+    }
+
+    ComponentsResult UnionFindComponents()
+    {
+        //
+        // One pass over the edge list; edges are taken as undirected, so on
+        // a directed graph these are the weakly connected components. No
+        // adjacency is needed.
+        //
+
+        UnionFind Sets;
+
+        Sets.Reset(VertexCount());
+
+        for (const Edge& edge : Edges)
+        {
+            Sets.Union(edge.first, edge.second);
+        }
+
+        std::vector<VertexId> Roots(VertexCount());
+
+        for (VertexId v = 0; v < VertexCount(); ++v)
+        {
+            Roots[v] = Sets.Find(v);
+        }
+
+        ComponentsResult Result;
+
+        Result.FromRoots(Roots);
+
+        return Result;
+    }
+
+    ComponentsResult ParallelComponents(unsigned int ThreadCount = 0, unsigned int NeighborRounds = 2)
+    {
+        PreScan();
+
+        return ::ParallelComponents(Out, Directed ? &InEdges() : nullptr, ThreadCount, NeighborRounds);
+    }
+
+    unsigned int ConnectedComponents(unsigned int& SmallestComponent, unsigned int& LargestComponent)
+    {
+        const ComponentsResult Result{ UnionFindComponents() };
+
+        SmallestComponent = Result.SmallestComponent;
+        LargestComponent = Result.LargestComponent;
+
+        return Result.Count;
+    }
+
+    int ShortestDistance(std::string_view From, std::string_view To)
+    {
+        if (From == To)
+        {
+            return 0;
+        }
+
+        PreWalk();
+
+        const VertexId Source{ FindVertex(From) };
+        const VertexId Target{ FindVertex(To) };
+
+        if ((Source == InvalidVertex) || (Target == InvalidVertex))
+        {
+            return -1;
+        }
+
+        if (Source == Target)
+        {
+            return 0;
+        }
+
+        int Distance;
+        bool Hot;
+
+        if (CachedDistances.Lookup(Version, Source, Target, Distance, Hot))
+        {
+            return Distance;
+        }
+
+        if (Hot)
+        {
+            std::vector<int> FromSource{ DistancesFrom(Source) };
+
+            Distance = FromSource[Target];
+            CachedDistances.StoreSource(Version, Source, std::move(FromSource));
+        }
+        else
+        {
+            Distance = BidirectionalDistance(Source, Target);
+            CachedDistances.Store(Version, Source, Target, Distance);
+        }
+
+        return Distance;
+    }
+
+    //
+    // Distances from Source to every vertex, -1 where it cannot get to.
+    //
+
+    std::vector<int> DistancesFrom(VertexId Source)
+    {
+        std::vector<int> Distance(VertexCount(), -1);
+        std::vector<VertexId> Queue{ Source };
+
+        Distance[Source] = 0;
+
+        for (size_t Head = 0; Head < Queue.size(); ++Head)
+        {
+            const VertexId u{ Queue[Head] };
+
+            ForEachEdge(Out, OutDelta, u, [&](VertexId w, Weight)
+            {
+                if (Distance[w] < 0)
+                {
+                    Distance[w] = Distance[u] + 1;
+                    Queue.push_back(w);
+                }
+            });
+        }
+
+        return Distance;
+    }
+
+    int BidirectionalDistance(VertexId Source, VertexId Target)
+    {
+        //
+        // The backward side follows the in-edges, which are the out-edges
+        // themselves on an undirected graph.
+        //
+
+        if (Directed)
+        {
+            UpdateInAdjacency(false);
+        }
+
+        const CsrAdjacency& Reverse{ Directed ? In : Out };
+        const DeltaAdjacency& ReverseDelta{ Directed ? InDelta : OutDelta };
+
+        return ::BidirectionalDistance(VertexCount(), Source, Target, Forward, Backward,
+            [this](VertexId u, auto&& visit) { ForEachEdge(Out, OutDelta, u, [&visit](VertexId w, Weight) { visit(w); }); },
+            [&](VertexId u, auto&& visit) { ForEachEdge(Reverse, ReverseDelta, u, [&visit](VertexId w, Weight) { visit(w); }); });
+    }
+
+    void DijkstraWorker(VertexId Source, const VertexId* Targets, size_t TargetCount)
+    {
+        //
+        // Settles vertices in cost order until every target is settled, or
+        // until everything reachable is when there are no targets. Weights
+        // must not be negative.
+        //
+
+        DijkstraState& State{ Dijkstra };
+
+        State.Reset(VertexCount());
+
+        size_t Remaining{ 0 };
+
+        for (size_t i = 0; i < TargetCount; ++i)
+        {
+            if (!State.Wanted.TestAndSet(Targets[i]))
+            {
+                ++Remaining;
+            }
+        }
+
+        State.Labeled.Set(Source);
+        State.Cost[Source] = 0;
+        State.Queue.Push(Source, 0);
+
+        while (!State.Queue.Empty())
+        {
+            const auto Top{ State.Queue.Pop() };
+            const VertexId u{ Top.Id };
+
+            State.Settled.Set(u);
+
+            if (State.Wanted.Test(u) && (--Remaining == 0))
+            {
+                break;
+            }
+
+            ForEachEdge(Out, OutDelta, u, [&](VertexId v, Weight EdgeCost)
+            {
+                if (State.Settled.Test(v))
+                {
+                    return;
+                }
+
+                const Weight Cost{ Top.Key + EdgeCost };
+
+                if (!State.Labeled.TestAndSet(v) || (Cost < State.Cost[v]))
+                {
+                    State.Cost[v] = Cost;
+                    State.Queue.Push(v, Cost);
+                }
+            });
+        }
+    }
+
+    Weight ShortestPath(std::string_view From, std::string_view To)
+    {
+        const std::vector<Weight> Costs{ ShortestPaths(From, { To }) };
+
+        return Costs.front(); // -1 when no path was found
+    }
+
+    std::vector<Weight> ShortestPaths(std::string_view From, const std::vector<std::string_view>& To)
+    {
+        //
+        // Weighted path costs from one source to several targets, -1 for
+        // the targets that cannot be reached. A single Dijkstra run serves
+        // all of them and stops once the last one is settled.
+        //
+
+        PreWalk();
+
+        std::vector<Weight> Costs(To.size(), -1);
+        std::vector<VertexId> Targets;
+
+        const VertexId Source{ FindVertex(From) };
+
+        if (Source == InvalidVertex)
+        {
+            return Costs;
+        }
+
+        for (std::string_view Name : To)
+        {
+            const VertexId Id{ FindVertex(Name) };
+
+            if (Id != InvalidVertex)
+            {
+                Targets.push_back(Id);
+            }
+        }
+
+        if (Targets.empty())
+        {
+            return Costs;
+        }
+
+        DijkstraWorker(Source, Targets.data(), Targets.size());
+
+        for (size_t i = 0; i < To.size(); ++i)
+        {
+            const VertexId Id{ FindVertex(To[i]) };
+
+            if ((Id != InvalidVertex) && Dijkstra.Settled.Test(Id))
+            {
+                Costs[i] = Dijkstra.Cost[Id];
+            }
+        }
+
+        return Costs;
+    }
+
+    std::vector<Weight> DijkstraCosts(std::string_view From)
+    {
+        //
+        // Costs from one source to every vertex, -1 where unreachable.
+        //
+
+        PreWalk();
+
+        std::vector<Weight> Costs(VertexCount(), -1);
+
+        const VertexId Source{ FindVertex(From) };
+
+        if (Source == InvalidVertex)
+        {
+            return Costs;
+        }
+
+        DijkstraWorker(Source, nullptr, 0);
+
+        for (VertexId v = 0; v < VertexCount(); ++v)
+        {
+            if (Dijkstra.Settled.Test(v))
+            {
+                Costs[v] = Dijkstra.Cost[v];
+            }
+        }
+
+        return Costs;
+    }
+
+    static bool AtomicMin(Weight& Slot, Weight Value)
+    {
+        std::atomic_ref<Weight> Ref(Slot);
+
+        Weight Current{ Ref.load(std::memory_order_relaxed) };
+
+        while (Value < Current)
+        {
+            if (Ref.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    Weight DeltaSteppingDelta()
+    {
+        //
+        // Meyer and Sanders suggest a bucket width around the largest weight
+        // over the average degree; twice the mean weight stands in for the
+        // largest one so a few outliers do not skew it. Never go below the
+        // lightest edge, or the leading buckets would all be empty.
+        //
+
+        PreScan();
+
+        const EdgeIndex EdgeCount{ Out.EdgeCount() };
+
+        if ((EdgeCount == 0) || Out.Weights.empty())
+        {
+            return 1;
+        }
+
+        Weight Total{ 0 };
+        Weight Lightest{ Out.Weights.front() };
+
+        for (Weight w : Out.Weights)
+        {
+            Total += w;
+            Lightest = std::min(Lightest, w);
+        }
+
+        const Weight MeanWeight{ Total / static_cast<Weight>(EdgeCount) };
+        const Weight MeanDegree{ static_cast<Weight>(EdgeCount) / static_cast<Weight>(VertexCount()) };
+
+        return std::max({ 2 * MeanWeight / MeanDegree, Lightest, std::numeric_limits<Weight>::min() });
+    }
+
+    std::vector<Weight> DeltaStepping(std::string_view From, Weight Delta = 0, unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        const VertexId Count{ VertexCount() };
+        const VertexId Source{ FindVertex(From) };
+
+        constexpr Weight Unreached{ std::numeric_limits<Weight>::infinity() };
+
+        std::vector<Weight> Distances(Count, Unreached);
+
+        if (Source == InvalidVertex)
+        {
+            Distances.assign(Count, -1);
+
+            return Distances;
+        }
+
+        if (Delta <= 0)
+        {
+            Delta = DeltaSteppingDelta();
+        }
+
+        //
+        // No shortest path is longer than VertexCount - 1 of the heaviest
+        // edges; keep Delta wide enough that the bucket index of any such
+        // distance fits in 62 bits.
+        //
+
+        Weight Heaviest{ Out.Weights.empty() ? 1.0 : 0.0 };
+
+        for (Weight w : Out.Weights)
+        {
+            if (std::isfinite(w))
+            {
+                Heaviest = std::max(Heaviest, w);
+            }
+        }
+
+        Delta = std::max(Delta, std::ldexp(Heaviest * static_cast<Weight>(Count), -62));
+
+        //
+        // Delta-stepping (Meyer and Sanders). Tentative distances fall into
+        // buckets of width Delta. The lowest non-empty bucket is drained in
+        // phases where the light edges (lighter than Delta) of its vertices
+        // are relaxed in parallel; light edges can refill the same bucket,
+        // hence the phases. Once it stays empty, the heavy edges of every
+        // vertex it held are relaxed once, since they can only land in later
+        // buckets. Relaxations are lock-free atomic minimums on the distance.
+        //
+        // Each worker keeps its own buckets and its own list of the vertices
+        // it drained; between phases the workers' share of the next bucket
+        // is copied side by side into the shared frontier. The buckets are a
+        // map keyed by bucket index holding only the non-empty ones, since
+        // the distances can span far more buckets than could be allocated.
+        //
+
+        constexpr size_t ChunkSize{ 64 };
+
+        const unsigned int Workers{ WorkerCount(ThreadCount) };
+
+        struct WorkerState
+        {
+            std::map<uint64_t, std::vector<VertexId>> Buckets;
+            std::vector<VertexId> Drained;
+        };
+
+        std::vector<WorkerState> States(Workers);
+        std::vector<size_t> Offsets(Workers + 1, 0);
+        std::vector<VertexId> Frontier{ Source };
+
+        std::atomic<size_t> Cursor{ 0 };
+
+        uint64_t Current{ 0 };
+        bool Refilled{ false };
+        bool Done{ false };
+
+        Distances[Source] = 0;
+
+        auto BucketOf = [Delta](Weight Distance)
+        {
+            return static_cast<uint64_t>(Distance / Delta);
+        };
+
+        auto Relax = [&](WorkerState& State, VertexId u, bool Light)
+        {
+            const Weight Base{ std::atomic_ref<Weight>(Distances[u]).load(std::memory_order_relaxed) };
+
+            for (EdgeIndex e = Out.Offsets[u]; e < Out.Offsets[u + 1]; ++e)
+            {
+                const Weight w{ Out.WeightAt(e) };
+
+                if ((w < Delta) != Light)
+                {
+                    continue;
+                }
+
+                const VertexId v{ Out.Targets[e] };
+                const Weight Candidate{ Base + w };
+
+                if (AtomicMin(Distances[v], Candidate))
+                {
+                    State.Buckets[BucketOf(Candidate)].push_back(v);
+                }
+            }
+        };
+
+        auto CurrentSize = [&Current](const WorkerState& State)
+        {
+            const auto Found{ State.Buckets.find(Current) };
+
+            return (Found != State.Buckets.end()) ? Found->second.size() : 0;
+        };
+
+        auto SizeFrontier = [&]()
+        {
+            for (unsigned int t = 0; t < Workers; ++t)
+            {
+                Offsets[t + 1] = Offsets[t] + CurrentSize(States[t]);
+            }
+
+            Frontier.resize(Offsets[Workers]);
+            Cursor.store(0, std::memory_order_relaxed);
+        };
+
+        std::barrier Sync(static_cast<ptrdiff_t>(Workers));
+
+        auto Worker = [&](unsigned int Index)
+        {
+            WorkerState& State{ States[Index] };
+
+            for (;;)
+            {
+                //
+                // Light phase over the current bucket. Entries whose distance
+                // has since dropped into an earlier bucket are stale.
+                //
+
+                for (;;)
+                {
+                    const size_t Begin{ Cursor.fetch_add(ChunkSize, std::memory_order_relaxed) };
+
+                    if (Begin >= Frontier.size())
+                    {
+                        break;
+                    }
+
+                    const size_t End{ std::min(Begin + ChunkSize, Frontier.size()) };
+
+                    for (size_t i = Begin; i < End; ++i)
+                    {
+                        const VertexId u{ Frontier[i] };
+
+                        if (BucketOf(std::atomic_ref<Weight>(Distances[u]).load(std::memory_order_relaxed)) < Current)
+                        {
+                            continue;
+                        }
+
+                        Relax(State, u, true);
+                        State.Drained.push_back(u);
+                    }
+                }
+
+                Sync.arrive_and_wait();
+
+                if (Index == 0)
+                {
+                    Refilled = false;
+
+                    for (const WorkerState& Other : States)
+                    {
+                        Refilled |= (CurrentSize(Other) != 0);
+                    }
+
+                    if (Refilled)
+                    {
+                        SizeFrontier();
+                    }
+                }
+
+                Sync.arrive_and_wait();
+
+                if (!Refilled)
+                {
+                    //
+                    // The bucket is settled: relax the heavy edges of all it
+                    // held, then move on to the lowest non-empty bucket.
+                    //
+
+                    for (VertexId u : State.Drained)
+                    {
+                        Relax(State, u, false);
+                    }
+
+                    State.Drained.clear();
+
+                    Sync.arrive_and_wait();
+
+                    if (Index == 0)
+                    {
+                        uint64_t Next{ UINT64_MAX };
+
+                        for (const WorkerState& Other : States)
+                        {
+                            const auto Found{ Other.Buckets.upper_bound(Current) };
+
+                            if (Found != Other.Buckets.end())
+                            {
+                                Next = std::min(Next, Found->first);
+                            }
+                        }
+
+                        Done = (Next == UINT64_MAX);
+
+                        if (!Done)
+                        {
+                            Current = Next;
+                            SizeFrontier();
+                        }
+                    }
+
+                    Sync.arrive_and_wait();
+
+                    if (Done)
+                    {
+                        break;
+                    }
+                }
+
+                const auto Found{ State.Buckets.find(Current) };
+
+                if (Found != State.Buckets.end())
+                {
+                    std::copy(Found->second.begin(), Found->second.end(), Frontier.begin() + static_cast<ptrdiff_t>(Offsets[Index]));
+                    State.Buckets.erase(Found);
+                }
+
+                Sync.arrive_and_wait();
+            }
+        };
+
+        std::vector<std::thread> Threads;
+
+        for (unsigned int t = 1; t < Workers; ++t)
+        {
+            Threads.emplace_back(Worker, t);
+        }
+
+        Worker(0);
+
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+
+        for (Weight& Distance : Distances)
+        {
+            if (Distance == Unreached)
+            {
+                Distance = -1;
+            }
+        }
+
+        return Distances;
+    }
+
+    std::vector<std::vector<int>> MultiSourceBfs(const std::vector<std::string_view>& Sources, unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        std::vector<VertexId> Ids(Sources.size());
+
+        for (size_t i = 0; i < Sources.size(); ++i)
+        {
+            Ids[i] = FindVertex(Sources[i]);
+        }
+
+        return ::MultiSourceBfs(Out, Ids, ThreadCount);
+    }
+
+    PageRankResult PageRank(const PageRankOptions& Options = PageRankOptions())
+    {
+        PreScan();
+
+        return ::PageRank(Out, Directed ? InEdges() : Out, {}, Options);
+    }
+
+    PageRankResult PersonalizedPageRank(const std::vector<std::string_view>& Seeds, const PageRankOptions& Options = PageRankOptions())
+    {
+        //
+        // Unknown seeds are ignored; with none left every rank is 0.
+        //
+
+        PreScan();
+
+        std::vector<VertexId> Ids;
+
+        for (std::string_view Seed : Seeds)
+        {
+            Ids.push_back(FindVertex(Seed));
+        }
+
+        return ::PageRank(Out, Directed ? InEdges() : Out, Ids, Options);
+    }
+
+    uint64_t CountTriangles(unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        return ::CountTriangles(Out, Directed ? &InEdges() : nullptr, ThreadCount);
+    }
+
+    TriangleResult ClusteringCoefficients(unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        return ::LocalTriangles(Out, Directed ? &InEdges() : nullptr, ThreadCount);
+    }
+
+    SccResult StronglyConnectedComponents()
+    {
+        PreScan();
+
+        return ::StronglyConnectedComponents(Out);
+    }
+
+    SccResult ParallelStronglyConnectedComponents(unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        return ::ParallelStronglyConnectedComponents(Out, Directed ? InEdges() : Out, ThreadCount);
+    }
+
+    TopologicalResult TopologicalSort(unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        return ::TopologicalSort(Out, ThreadCount);
+    }
+
+    template <typename Task>
+    bool RunInDependencyOrder(Task&& task, unsigned int ThreadCount = 0)
+    {
+        //
+        // Task(Name) for every vertex, once those it depends on are done.
+        //
+
+        PreScan();
+
+        return ::RunInDependencyOrder(Out, [&](VertexId v) { task(VertexName(v)); }, ThreadCount);
+    }
+
+    //
+    // On undirected graphs every pair is seen from both ends, so the sums
+    // are halved to count each path once.
+    //
+
+    std::vector<double> Betweenness(const BetweennessOptions& Options = BetweennessOptions())
+    {
+        PreScan();
+
+        std::vector<double> Centrality{ ::Betweenness(Out, Options) };
+
+        if (!Directed)
+        {
+            for (double& Value : Centrality)
+            {
+                Value /= 2;
+            }
+        }
+
+        return Centrality;
+    }
+
+    ReachabilityIndex BuildReachabilityIndex(unsigned int Labels = 3, unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        ReachabilityIndex Index;
+
+        Index.Build(Out, Labels, 27491095, ThreadCount);
+
+        return Index;
+    }
+
+    std::vector<VertexId> CoreNumbers()
+    {
+        PreScan();
+
+        return Directed ? ::CoreNumbers(Symmetrize(Out)) : ::CoreNumbers(Out);
+    }
+
+    std::vector<VertexId> ParallelCoreNumbers(unsigned int ThreadCount = 0)
+    {
+        PreScan();
+
+        return Directed ? ::ParallelCoreNumbers(Symmetrize(Out, ThreadCount), ThreadCount) : ::ParallelCoreNumbers(Out, ThreadCount);
+    }
+
+    SpanningForest MinimumSpanningForest(unsigned int ThreadCount = 0)
+    {
+        return ::KruskalSpanningForest(VertexCount(), Edges, EdgeWeights, ThreadCount);
+    }
+
+    SpanningForest ParallelMinimumSpanningForest(unsigned int ThreadCount = 0)
+    {
+        return ::BoruvkaSpanningForest(VertexCount(), Edges, EdgeWeights, ThreadCount);
+    }
+
+    std::shared_ptr<const FrozenGraph> Freeze()
+    {
+        PreScan();
+
+        std::shared_ptr<FrozenGraph> Frozen{ std::make_shared<FrozenGraph>() };
+
+        //
+        // Interning the names in id order gives every vertex the same id.
+        //
+
+        for (VertexId v = 0; v < VertexCount(); ++v)
+        {
+            Frozen->Names.Intern(VertexName(v));
+        }
+
+        Frozen->Out = Out;
+
+        if (Directed)
+        {
+            Frozen->In = InEdges();
+        }
+
+        Frozen->Directed = Directed;
+        Frozen->Version = Version;
+
+        return Frozen;
+    }
+
+    void Publish()
+    {
+        Published.Snapshot.store(Freeze());
+    }
+
+    std::shared_ptr<const FrozenGraph> Current() const
+    {
+        return Published.Snapshot.load();
+    }
+
+    bool Reorder(const std::vector<VertexId>& NewIds, unsigned int ThreadCount = 0)
+    {
+        //
+        // Relabels the vertices, NewIds[v] being the new id of v, and
+        // rebuilds the adjacency under the new ids. Names keep resolving to
+        // the same vertices. Fails, changing nothing, unless NewIds is a
+        // permutation of the ids.
+        //
+
+        const VertexId Count{ VertexCount() };
+
+        if (NewIds.size() != Count)
+        {
+            return false;
+        }
+
+        VisitedBitmap Taken;
+
+        Taken.Reset(Count);
+
+        for (VertexId Id : NewIds)
+        {
+            if ((Id >= Count) || Taken.TestAndSet(Id))
+            {
+                return false;
+            }
+        }
+
+        Names.Permute(NewIds);
+
+        ParallelFor(Edges.size(), ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t e = Begin; e < End; ++e)
+            {
+                Edges[e] = Edge(NewIds[Edges[e].first], NewIds[Edges[e].second]);
+            }
+        }, 64 * 1024);
+
+        Out.Build(Count, Edges, false, EdgeWeights, ThreadCount);
+        OutDelta.Clear();
+        In.Clear();
+        InDelta.Clear();
+        ++Version;
+
+        Dirty = false;
+        InDirty = true;
+
+        return true;
+    }
+
+    bool LoadEdgeList(const char* Path, bool Undirected = true, bool IntegerIds = true, unsigned int ThreadCount = 0)
+    {
+        //
+        // Replaces the graph with the edges of a text edge list. The file is
+        // memory mapped and cut into chunks at line boundaries, which are
+        // parsed in parallel. With IntegerIds the ids are used as the dense
+        // vertex ids directly (and named after themselves), which suits the
+        // usual 0-based edge lists; sparse or non-numeric ids should use
+        // string ids, which get interned in file order once parsing is done.
+        // The adjacency is built straight away. Returns false if the file
+        // cannot be read or has malformed lines.
+        //
+
+        constexpr size_t ChunkBytes{ 4 * 1024 * 1024 };
+
+        MappedFile File;
+
+        if (!File.Open(Path))
+        {
+            return false;
+        }
+
+        Clear();
+
+        const size_t ChunkCount{ std::max<size_t>(1, File.Size / ChunkBytes) };
+
+        std::vector<const char*> Bounds(ChunkCount + 1, File.Data + File.Size);
+
+        Bounds[0] = File.Data;
+
+        for (size_t c = 1; c < ChunkCount; ++c)
+        {
+            const char* Split{ std::max(File.Data + c * (File.Size / ChunkCount), Bounds[c - 1]) };
+            const char* NewLine{ static_cast<const char*>(memchr(Split, '\n', static_cast<size_t>(File.Data + File.Size - Split))) };
+
+            Bounds[c] = NewLine ? NewLine + 1 : File.Data + File.Size;
+        }
+
+        std::vector<ParsedChunk> Chunks(ChunkCount);
+
+        ParallelFor(ChunkCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t c = Begin; c < End; ++c)
+            {
+                Chunks[c].Parse(Bounds[c], Bounds[c + 1], IntegerIds);
+            }
+        }, 1);
+
+        //
+        // Lay the chunks out one after the other, in file order.
+        //
+
+        std::vector<size_t> First(ChunkCount + 1, 0);
+        bool Weighted{ false };
+        VertexId MaxId{ 0 };
+
+        for (size_t c = 0; c < ChunkCount; ++c)
+        {
+            if (Chunks[c].Malformed)
+            {
+                Clear();
+
+                return false;
+            }
+
+            First[c + 1] = First[c] + (IntegerIds ? Chunks[c].Edges.size() : Chunks[c].Names.size());
+            Weighted |= !Chunks[c].Weights.empty();
+            MaxId = std::max(MaxId, Chunks[c].MaxId);
+        }
+
+        const size_t Parsed{ First[ChunkCount] };
+
+        Edges.resize(Undirected ? Parsed * 2 : Parsed);
+        EdgeWeights.resize(Weighted ? Edges.size() : 0);
+
+        if (IntegerIds)
+        {
+            if (Parsed)
+            {
+                char Buffer[16];
+
+                for (VertexId v = 0; v <= MaxId; ++v)
+                {
+                    Names.Intern(std::string_view(Buffer, static_cast<size_t>(std::to_chars(Buffer, Buffer + sizeof(Buffer), v).ptr - Buffer)));
+                }
+            }
+
+            ParallelFor(ChunkCount, ThreadCount, [&](size_t Begin, size_t End)
+            {
+                for (size_t c = Begin; c < End; ++c)
+                {
+                    std::copy(Chunks[c].Edges.begin(), Chunks[c].Edges.end(), Edges.begin() + static_cast<ptrdiff_t>(First[c]));
+                }
+            }, 1);
+        }
+        else
+        {
+            for (size_t c = 0; c < ChunkCount; ++c)
+            {
+                size_t e{ First[c] };
+
+                for (const auto& Pair : Chunks[c].Names)
+                {
+                    const VertexId From{ Names.Intern(Pair.first) };
+                    const VertexId To{ Names.Intern(Pair.second) };
+
+                    Edges[e++] = Edge(From, To);
+                }
+            }
+        }
+
+        ParallelFor(ChunkCount, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t c = Begin; c < End; ++c)
+            {
+                const size_t Count{ First[c + 1] - First[c] };
+
+                if (Weighted)
+                {
+                    const std::vector<Weight>& Costs{ Chunks[c].Weights };
+
+                    for (size_t i = 0; i < Count; ++i)
+                    {
+                        EdgeWeights[First[c] + i] = (i < Costs.size()) ? Costs[i] : 1;
+                    }
+                }
+
+                if (Undirected)
+                {
+                    for (size_t i = First[c]; i < First[c + 1]; ++i)
+                    {
+                        Edges[Parsed + i] = Edge(Edges[i].second, Edges[i].first);
+
+                        if (Weighted)
+                        {
+                            EdgeWeights[Parsed + i] = EdgeWeights[i];
+                        }
+                    }
+                }
+            }
+        }, 1);
+
+        Directed = !Undirected;
+
+        Out.Build(VertexCount(), Edges, false, EdgeWeights, ThreadCount);
+
+        Dirty = false;
+        InDirty = true;
+
+        return true;
+    }
+
+    bool SaveSnapshot(const char* Path)
+    {
+        PreScan();
+
+        const VertexId Count{ VertexCount() };
+
+        std::vector<uint64_t> NameOffsets(static_cast<size_t>(Count) + 1, 0);
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            NameOffsets[v + 1] = NameOffsets[v] + VertexName(v).size();
+        }
+
+        SnapshotHeader Header{};
+
+        memcpy(Header.Magic, SnapshotHeader::ExpectedMagic, sizeof(Header.Magic));
+        Header.Version = SnapshotHeader::CurrentVersion;
+        Header.Flags = (Out.Weights.empty() ? 0 : SnapshotHeader::WeightedFlag) | (Directed ? SnapshotHeader::DirectedFlag : 0);
+        Header.VertexCount = Count;
+        Header.EdgeCount = Out.EdgeCount();
+        Header.NameBytes = NameOffsets[Count];
+
+        std::ofstream Stream(Path, std::ios::binary | std::ios::trunc);
+
+        auto Write = [&Stream](const void* Data, size_t Bytes)
+        {
+            Stream.write(static_cast<const char*>(Data), static_cast<std::streamsize>(Bytes));
+        };
+
+        const uint64_t Padding{ 0 };
+
+        Write(&Header, sizeof(Header));
+        Write(Out.Offsets.data(), Out.Offsets.size() * sizeof(EdgeIndex));
+        Write(Out.Targets.data(), Out.Targets.size() * sizeof(VertexId));
+        Write(&Padding, (Out.Targets.size() % 2) * sizeof(VertexId));
+        Write(Out.Weights.data(), Out.Weights.size() * sizeof(Weight));
+        Write(NameOffsets.data(), NameOffsets.size() * sizeof(uint64_t));
+
+        for (VertexId v = 0; v < Count; ++v)
+        {
+            Write(VertexName(v).data(), VertexName(v).size());
+        }
+
+        return Stream.good();
+    }
+
+    bool LoadSnapshot(const char* Path, unsigned int ThreadCount = 0)
+    {
+        //
+        // Replaces the graph with a snapshot written by SaveSnapshot. The
+        // arrays are block copied out of the mapping; only the names need
+        // hashing again, and the edge list is rebuilt from the adjacency.
+        //
+
+        MappedFile File;
+
+        if (!File.Open(Path) || (File.Size < sizeof(SnapshotHeader)))
+        {
+            return false;
+        }
+
+        SnapshotHeader Header;
+
+        memcpy(&Header, File.Data, sizeof(Header));
+
+        if ((memcmp(Header.Magic, SnapshotHeader::ExpectedMagic, sizeof(Header.Magic)) != 0) ||
+            (Header.Version != SnapshotHeader::CurrentVersion) ||
+            (Header.VertexCount >= InvalidVertex))
+        {
+            return false;
+        }
+
+        //
+        // Bound every count by the file size before any offset arithmetic,
+        // so a crafted header can neither wrap the sums below around nor ask
+        // for more memory than the file could possibly describe.
+        //
+
+        const size_t Payload{ File.Size - sizeof(SnapshotHeader) };
+
+        if ((Header.VertexCount >= Payload / (2 * sizeof(uint64_t))) ||
+            (Header.EdgeCount > Payload / sizeof(VertexId)) ||
+            (Header.NameBytes > Payload))
+        {
+            return false;
+        }
+
+        const bool Weighted{ (Header.Flags & SnapshotHeader::WeightedFlag) != 0 };
+        const VertexId Count{ static_cast<VertexId>(Header.VertexCount) };
+        const size_t EdgeCount{ static_cast<size_t>(Header.EdgeCount) };
+
+        const size_t OffsetsAt{ sizeof(SnapshotHeader) };
+        const size_t TargetsAt{ OffsetsAt + (static_cast<size_t>(Count) + 1) * sizeof(EdgeIndex) };
+        const size_t WeightsAt{ TargetsAt + ((EdgeCount + 1) / 2) * 2 * sizeof(VertexId) };
+        const size_t NameOffsetsAt{ WeightsAt + (Weighted ? EdgeCount * sizeof(Weight) : 0) };
+        const size_t NamesAt{ NameOffsetsAt + (static_cast<size_t>(Count) + 1) * sizeof(uint64_t) };
+
+        if (NamesAt + Header.NameBytes != File.Size)
+        {
+            return false;
+        }
+
+        Clear();
+
+        Out.Offsets.resize(static_cast<size_t>(Count) + 1);
+        Out.Targets.resize(EdgeCount);
+        Out.Weights.resize(Weighted ? EdgeCount : 0);
+
+        std::vector<uint64_t> NameOffsets(static_cast<size_t>(Count) + 1);
+
+        auto Copy = [&File](void* Destination, size_t At, size_t Bytes)
+        {
+            if (Bytes)
+            {
+                memcpy(Destination, File.Data + At, Bytes);
+            }
+        };
+
+        Copy(Out.Offsets.data(), OffsetsAt, Out.Offsets.size() * sizeof(EdgeIndex));
+        Copy(Out.Targets.data(), TargetsAt, Out.Targets.size() * sizeof(VertexId));
+        Copy(Out.Weights.data(), WeightsAt, Out.Weights.size() * sizeof(Weight));
+        Copy(NameOffsets.data(), NameOffsetsAt, NameOffsets.size() * sizeof(uint64_t));
+
+        bool Corrupt{ (Out.Offsets[0] != 0) || (Out.Offsets[Count] != EdgeCount) ||
+                      (NameOffsets[0] != 0) || (NameOffsets[Count] != Header.NameBytes) };
+
+        for (VertexId v = 0; (v < Count) && !Corrupt; ++v)
+        {
+            Corrupt = (Out.Offsets[v] > Out.Offsets[v + 1]) || (NameOffsets[v] > NameOffsets[v + 1]) ||
+                      (Names.Intern(std::string_view(File.Data + NamesAt + NameOffsets[v], NameOffsets[v + 1] - NameOffsets[v])) != v);
+        }
+
+        std::atomic<bool> BadTarget{ false };
+
+        Edges.resize(Corrupt ? 0 : EdgeCount);
+
+        ParallelFor(Corrupt ? 0 : Count, ThreadCount, [&](size_t Begin, size_t End)
+        {
+            for (size_t u = Begin; u < End; ++u)
+            {
+                //
+                // Target lists have to be sorted and free of duplicates, as
+                // the incremental updates, the sorted intersections and the
+                // gap encoding all rely on it.
+                //
+
+                for (EdgeIndex e = Out.Offsets[u]; e < Out.Offsets[u + 1]; ++e)
+                {
+                    if ((Out.Targets[e] >= Count) || ((e > Out.Offsets[u]) && (Out.Targets[e - 1] >= Out.Targets[e])))
+                    {
+                        BadTarget.store(true, std::memory_order_relaxed);
+                    }
+
+                    Edges[e] = Edge(static_cast<VertexId>(u), Out.Targets[e]);
+                }
+            }
+        });
+
+        if (Corrupt || BadTarget.load())
+        {
+            Clear();
+
+            return false;
+        }
+
+        EdgeWeights = Out.Weights;
+
+        Directed = (Header.Flags & SnapshotHeader::DirectedFlag) != 0;
+        Dirty = false;
+        InDirty = true;
+
+        return true;
+    }
+};
+
+#include <iostream>
+#include <chrono>
+#include <filesystem>
+
+void DumpAdjacencyList(Graph& g)
+{
+    g.PreWalk();
+
+    if (g.VertexCount() == 0)
+    {
+        std::cout << "The adjacency list is empty.\n";
+    }
+
+    //
+    // Listed in name order, vertices and neighbors alike, whatever ids the
+    // names were interned under.
+    //
+
+    auto ByName = [&g](VertexId a, VertexId b)
+    {
+        return g.VertexName(a) < g.VertexName(b);
+    };
+
+    std::vector<VertexId> Order(g.VertexCount());
+
+    std::iota(Order.begin(), Order.end(), VertexId{ 0 });
+    std::sort(Order.begin(), Order.end(), ByName);
+
+    for (VertexId vertex : Order)
+    {
+        std::vector<VertexId> Neighbors;
+
+        g.ForEachNeighbor(vertex, [&Neighbors](VertexId neighbor)
+        {
+            Neighbors.push_back(neighbor);
+        });
+
+        std::sort(Neighbors.begin(), Neighbors.end(), ByName);
+
+        std::cout << g.VertexName(vertex) << ": [";
+
+        for (size_t i = 0; i < Neighbors.size(); ++i)
+        {
+            std::cout << (i ? ", " : "") << g.VertexName(Neighbors[i]);
+        }
+
+        std::cout << "]\n";
+    }
+
+    std::cout << "\n";
+}
+
+bool PrintVertex(std::string_view Name, [[maybe_unused]] int Distance, [[maybe_unused]] void* Context)
+{
+    std::cout << Name << "\n";
+
+    return true; // Continue walk
+}
+
+//
+// Builds an undirected R-MAT graph (Chakrabarti, Zhan and Faloutsos) with
+// 2^Scale vertices and EdgeFactor edges per vertex. The recursive quadrant
+// skew gives the power-law degrees and small diameter of social graphs.
+//
+
+void BuildRmatGraph(Graph& g, unsigned int Scale, unsigned int EdgeFactor, unsigned int MaxWeight = 1, uint32_t Seed = 27491095, bool Undirected = true)
+{
+    std::mt19937 Random(Seed);
+    std::uniform_real_distribution<double> Uniform(0.0, 1.0);
+    std::uniform_int_distribution<unsigned int> Cost(1, std::max(MaxWeight, 1u));
+
+    const uint64_t EdgeCount{ (1ull << Scale) * EdgeFactor };
+
+    for (uint64_t e = 0; e < EdgeCount; ++e)
+    {
+        uint32_t From{ 0 };
+        uint32_t To{ 0 };
+
+        for (unsigned int bit = 0; bit < Scale; ++bit)
+        {
+            const double r{ Uniform(Random) };
+
+            if (r >= 0.57)
+            {
+                if (r < 0.76)
+                {
+                    To |= (1u << bit);
+                }
+                else if (r < 0.95)
+                {
+                    From |= (1u << bit);
+                }
+                else
+                {
+                    From |= (1u << bit);
+                    To |= (1u << bit);
+                }
+            }
+        }
+
+        if (From == To)
+        {
+            continue;
+        }
+
+        if (Undirected)
+        {
+            g.AddUndirectedEdge(std::to_string(From), std::to_string(To), Cost(Random));
+        }
+        else
+        {
+            g.AddDirectedEdge(std::to_string(From), std::to_string(To), Cost(Random));
+        }
+    }
+}
+
+//
+// Builds a Width x Height grid with random costs from 1 to MaxWeight, a
+// stand-in for road networks: low degree, large diameter.
+//
+
+void BuildGridGraph(Graph& g, unsigned int Width, unsigned int Height, unsigned int MaxWeight, uint32_t Seed = 27491095)
+{
+    std::mt19937 Random(Seed);
+    std::uniform_int_distribution<unsigned int> Cost(1, std::max(MaxWeight, 1u));
+
+    for (unsigned int y = 0; y < Height; ++y)
+    {
+        for (unsigned int x = 0; x < Width; ++x)
+        {
+            const std::string Here{ std::to_string(y * Width + x) };
+
+            if (x + 1 < Width)
+            {
+                g.AddUndirectedEdge(Here, std::to_string(y * Width + x + 1), Cost(Random));
+            }
+
+            if (y + 1 < Height)
+            {
+                g.AddUndirectedEdge(Here, std::to_string((y + 1) * Width + x), Cost(Random));
+            }
+        }
+    }
+}
+
+//
+// Times Dijkstra against delta-stepping with the automatic bucket width and
+// with a width 8x narrower and 8x wider, checking that they all agree.
+//
+
+void BenchmarkShortestPaths(Graph& g, std::string_view Label, std::string_view Source)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto Milliseconds = [](Clock::time_point Start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+    };
+
+    g.PreScan();
+
+    std::cout << "\n" << Label << ": " << g.VertexCount() << " vertices, " << g.Out.EdgeCount() << " edges\n";
+
+    Clock::time_point Start{ Clock::now() };
+
+    const std::vector<Weight> Expected{ g.DijkstraCosts(Source) };
+
+    std::cout << "    Dijkstra: " << Milliseconds(Start) << " ms\n";
+
+    const Weight Delta{ g.DeltaSteppingDelta() };
+
+    for (Weight Width : { Delta / 8, Delta, Delta * 8 })
+    {
+        Start = Clock::now();
+
+        const bool Agrees{ g.DeltaStepping(Source, Width) == Expected };
+
+        std::cout << "    Delta-stepping (delta " << Width << (Width == Delta ? ", auto" : "") << "): "
+                  << Milliseconds(Start) << " ms" << (Agrees ? "" : " MISMATCH") << "\n";
+    }
+}
+
+//
+// Relabels a graph under each ordering and times BFS and single-threaded
+// PageRank over the result, next to the edge gap score of the ordering.
+// Sources are the same vertices under every labeling.
+//
+
+void BenchmarkOrderings(Graph& g, std::string_view Label)
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto Milliseconds = [](Clock::time_point Start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+    };
+
+    g.PreScan();
+
+    const CsrAdjacency& Base{ g.Out };
+    const CsrAdjacency& Incoming{ g.InEdges() };
+    const VertexId Count{ g.VertexCount() };
+
+    std::cout << "\n" << Label << ": " << Count << " vertices, " << Base.EdgeCount() << " edges\n";
+
+    std::mt19937 Random(27491095);
+    std::vector<VertexId> Sources;
+
+    for (VertexId v = 0; v < Count; v += Count / 16 + 1)
+    {
+        Sources.push_back(v);
+    }
+
+    auto Run = [&](std::string_view Name, const std::vector<VertexId>& NewIds, double OrderTime)
+    {
+        const CsrAdjacency Permuted{ PermuteAdjacency(Base, NewIds) };
+        const CsrAdjacency PermutedIn{ PermuteAdjacency(Incoming, NewIds) };
+
+        CompressedAdjacency Compressed;
+
+        Compressed.Build(Permuted);
+
+        VertexId Reached{ 0 };
+
+        Clock::time_point Start{ Clock::now() };
+
+        for (VertexId Source : Sources)
+        {
+            Reached += DirectionOptimizingBfs(Permuted, PermutedIn, NewIds[Source]).Reached;
+        }
+
+        const double DirectionOptimizingTime{ Milliseconds(Start) };
+
+        Start = Clock::now();
+
+        for (VertexId Source : Sources)
+        {
+            Reached -= ParallelBfs(Permuted, NewIds[Source], 1).Reached;
+        }
+
+        const double TopDownTime{ Milliseconds(Start) };
+
+        PageRankOptions Options;
+
+        Options.ThreadCount = 1;
+
+        Start = Clock::now();
+
+        const PageRankResult Ranks{ PageRank(Permuted, PermutedIn, {}, Options) };
+
+        std::cout << "    " << Name << " (" << OrderTime << " ms): gap score " << EdgeGapScore(Permuted)
+                  << ", compressed " << 8.0 * static_cast<double>(Compressed.Bytes.size()) / static_cast<double>(Permuted.EdgeCount()) << " bits/edge"
+                  << ", DO-BFS " << DirectionOptimizingTime << " ms, top-down BFS " << TopDownTime << " ms, PageRank "
+                  << Milliseconds(Start) << " ms (" << Ranks.Iterations << " iterations)"
+                  << (Reached ? " MISMATCH" : "") << "\n";
+    };
+
+    std::vector<VertexId> NewIds(Count);
+
+    std::iota(NewIds.begin(), NewIds.end(), VertexId{ 0 });
+
+    Run("Insertion order", NewIds, 0);
+
+    std::shuffle(NewIds.begin(), NewIds.end(), Random);
+
+    Run("Random", NewIds, 0);
+
+    Clock::time_point Start{ Clock::now() };
+
+    NewIds = DegreeOrder(Base);
+
+    Run("Hub sort", NewIds, Milliseconds(Start));
+
+    Start = Clock::now();
+
+    NewIds = DegreeOrder(Base, false);
+
+    Run("Degree sort", NewIds, Milliseconds(Start));
+
+    Start = Clock::now();
+
+    NewIds = ReverseCuthillMcKeeOrder(Base);
+
+    Run("Reverse Cuthill-McKee", NewIds, Milliseconds(Start));
+
+    Start = Clock::now();
+
+    NewIds = GorderOrder(Base, Incoming);
+
+    Run("Gorder", NewIds, Milliseconds(Start));
+}
+
+int main()
+{
+    std::cout << "Hello Graphs!\n\n";
+
+    Graph g;
+
+    g.AddUndirectedEdge("1", "2");
+    g.AddVertex("3");
+    g.AddUndirectedEdge("4", "6");
+    g.AddUndirectedEdge("5", "6");
+    g.AddUndirectedEdge("7", "6");
+    g.AddUndirectedEdge("8", "6");
+
+    DumpAdjacencyList(g);
+
+    unsigned int LargestComponent;
+    unsigned int SmallestComponent;
+
+    unsigned int ConnectedComponents{ g.ConnectedComponents(SmallestComponent, LargestComponent) };
+ 
+    if (ConnectedComponents)
+    {
+        std::cout << "Connected components: " << ConnectedComponents << "\n";
+        std::cout << "Smallest component: " << SmallestComponent << "\n";
+        std::cout << "Largest component: " << LargestComponent << "\n\n";
+    }
+
+    g.Clear();
+
+    g.AddUndirectedEdge("w", "x");
+    g.AddUndirectedEdge("x", "y");
+    g.AddUndirectedEdge("z", "y");
+    g.AddUndirectedEdge("u", "v");
+    g.AddUndirectedEdge("z", "u");
+    g.AddUndirectedEdge("w", "v");
+    g.AddUndirectedEdge("w", "y");
+
+    DumpAdjacencyList(g);
+
+    ConnectedComponents = g.ConnectedComponents(SmallestComponent, LargestComponent);
+ 
+    if (ConnectedComponents)
+    {
+        std::cout << "Connected components: " << ConnectedComponents << "\n";
+        std::cout << "Smallest component: " << SmallestComponent << "\n";
+        std::cout << "Largest component: " << LargestComponent << "\n\n";
+    }
+
+    std::cout << "DFS walk:\n\n";
+
+    g.DfsWalk("w", nullptr, PrintVertex);
+
+    std::cout << "\nBFS walk:\n\n";
+
+    g.BfsWalk("w", nullptr, PrintVertex);
+
+    //
+    // Same walk with an inlined lambda visitor, stopping at the first vertex
+    // two hops away.
+    //
+
+    unsigned int Adjacent{ 0 };
+
+    g.BfsWalk("w", nullptr, [&Adjacent](VertexId, int Distance)
+    {
+        Adjacent += (Distance == 1);
+
+        return Distance < 2;
+    });
+
+    std::cout << "\nVertices adjacent to 'w' : " << Adjacent << "\n";
+
+    std::cout << "\nShortest distance from 'w' to 'z' : " << g.ShortestDistance("w", "z") << "\n";
+
+    g.Clear();
+
+    g.AddUndirectedEdge("Seattle", "Portland", 174);
+    g.AddUndirectedEdge("Portland", "Boise", 430);
+    g.AddUndirectedEdge("Seattle", "Spokane", 280);
+    g.AddUndirectedEdge("Spokane", "Boise", 290);
+    g.AddUndirectedEdge("Seattle", "Boise", 600);
+
+    std::cout << "\nCheapest route from 'Seattle' to 'Boise' : " << g.ShortestPath("Seattle", "Boise") << "\n";
+
+    const std::vector<std::string_view> Destinations{ "Portland", "Spokane", "Boise" };
+    const std::vector<Weight> Costs{ g.ShortestPaths("Seattle", Destinations) };
+
+    for (size_t i = 0; i < Destinations.size(); ++i)
+    {
+        std::cout << "Cheapest route from 'Seattle' to '" << Destinations[i] << "' : " << Costs[i] << "\n";
+    }
+
+    //
+    // A build: each edge goes from a target to one that depends on it.
+    //
+
+    g.Clear();
+
+    g.AddDirectedEdge("config", "core");
+    g.AddDirectedEdge("config", "net");
+    g.AddDirectedEdge("core", "app");
+    g.AddDirectedEdge("net", "app");
+    g.AddDirectedEdge("core", "tests");
+    g.AddDirectedEdge("app", "package");
+    g.AddDirectedEdge("tests", "package");
+
+    TopologicalResult Plan{ g.TopologicalSort() };
+
+    std::cout << "\nBuild levels:\n";
+
+    for (VertexId Level = 0; Level < Plan.LevelCount; ++Level)
+    {
+        std::cout << "    " << Level << ":";
+
+        for (VertexId v : Plan.Order)
+        {
+            if (Plan.Level[v] == Level)
+            {
+                std::cout << " " << g.VertexName(v);
+            }
+        }
+
+        std::cout << "\n";
+    }
+
+    std::atomic<unsigned int> Built{ 0 };
+
+    const bool Complete{ g.RunInDependencyOrder([&Built](std::string_view) { ++Built; }) };
+
+    std::cout << "Built " << Built << " targets" << (Complete ? "" : " (incomplete)") << "\n";
+
+    g.AddDirectedEdge("package", "config");
+
+    Plan = g.TopologicalSort();
+
+    std::cout << "After adding package -> config, cycle:";
+
+    for (VertexId v : Plan.Cycle)
+    {
+        std::cout << " " << g.VertexName(v);
+    }
+
+    std::cout << "\n";
+
+    g.Clear();
+
+    BuildGridGraph(g, 256, 256, 100);
+    BenchmarkShortestPaths(g, "Road-like grid", "0");
+
+    g.Clear();
+
+    BuildRmatGraph(g, 14, 16, 100);
+    BenchmarkShortestPaths(g, "Power-law R-MAT", "0");
+
+    //
+    // Distances spanning far more buckets than could ever be allocated,
+    // with bucket widths down to the smallest double.
+    //
+
+    g.Clear();
+
+    g.AddDirectedEdge("a", "b", 1e9);
+    g.AddDirectedEdge("b", "c", 1);
+    g.AddDirectedEdge("a", "c", 2e9);
+
+    bool WideAgrees{ true };
+
+    for (Weight Width : { 1.0, 1e-3, 1e-12, 1e-300 })
+    {
+        WideAgrees &= (g.DeltaStepping("a", Width) == g.DijkstraCosts("a"));
+    }
+
+    std::cout << "\nDelta-stepping over a 2e9 distance range with widths down to 1e-300: "
+              << (WideAgrees ? "agrees" : "MISMATCH") << " with Dijkstra\n";
+
+    g.Clear();
+
+    BuildRmatGraph(g, 16, 16);
+    BenchmarkOrderings(g, "Vertex orderings over R-MAT");
+
+    g.Clear();
+
+    BuildGridGraph(g, 256, 256, 1);
+
+    std::vector<VertexId> Shuffled(g.VertexCount());
+
+    std::iota(Shuffled.begin(), Shuffled.end(), VertexId{ 0 });
+    std::shuffle(Shuffled.begin(), Shuffled.end(), std::mt19937(27491095));
+
+    g.Reorder(Shuffled);
+
+    BenchmarkOrderings(g, "Vertex orderings over a shuffled grid");
+
+    g.Clear();
+
+    BuildRmatGraph(g, 14, 16);
+
+    BfsResult Bfs{ g.DirectionOptimizingBfs("0") };
+
+    std::cout << "\nDirection-optimizing BFS over R-MAT graph: reached " << Bfs.Reached
+              << " of " << g.VertexCount() << " vertices, examined "
+              << Bfs.EdgesExamined << " of " << g.Out.EdgeCount() << " edges\n";
+
+    Bfs = g.ParallelBfs("0");
+
+    std::cout << "Parallel BFS over R-MAT graph: reached " << Bfs.Reached
+              << " of " << g.VertexCount() << " vertices, examined "
+              << Bfs.EdgesExamined << " of " << g.Out.EdgeCount() << " edges\n";
+
+    std::vector<std::string> Names;
+    std::vector<std::string_view> Sources;
+
+    for (VertexId v = 0; v < 64; ++v)
+    {
+        Names.push_back(std::to_string(v * 97));
+    }
+
+    Sources.assign(Names.begin(), Names.end());
+
+    const std::vector<std::vector<int>> Hops{ g.MultiSourceBfs(Sources) };
+
+    double HopTotal{ 0 };
+    uint64_t PairCount{ 0 };
+
+    for (const std::vector<int>& Row : Hops)
+    {
+        for (int Hop : Row)
+        {
+            if (Hop > 0)
+            {
+                HopTotal += Hop;
+                ++PairCount;
+            }
+        }
+    }
+
+    std::cout << "Multi-source BFS over R-MAT graph: mean hop distance from " << Sources.size()
+              << " sources is " << (PairCount ? HopTotal / static_cast<double>(PairCount) : 0.0) << "\n";
+
+    ComponentsResult Components{ g.ParallelComponents() };
+
+    std::cout << "Parallel components over R-MAT graph: " << Components.Count
+              << " (smallest " << Components.SmallestComponent
+              << ", largest " << Components.LargestComponent << ")\n";
+
+    PageRankResult Ranks{ g.PageRank() };
+
+    VertexId Top{ static_cast<VertexId>(std::max_element(Ranks.Ranks.begin(), Ranks.Ranks.end()) - Ranks.Ranks.begin()) };
+
+    std::cout << "PageRank over R-MAT graph: converged in " << Ranks.Iterations << " iterations, top vertex "
+              << g.VertexName(Top) << " (degree " << g.Out.Degree(Top) << ", rank " << Ranks.Ranks[Top] << ")\n";
+
+    Ranks = g.PersonalizedPageRank({ "1", "2", "3" });
+    Ranks.Ranks[g.FindVertex("1")] = 0;
+    Ranks.Ranks[g.FindVertex("2")] = 0;
+    Ranks.Ranks[g.FindVertex("3")] = 0;
+
+    Top = static_cast<VertexId>(std::max_element(Ranks.Ranks.begin(), Ranks.Ranks.end()) - Ranks.Ranks.begin());
+
+    std::cout << "Personalized PageRank from 1, 2 and 3: converged in " << Ranks.Iterations
+              << " iterations, top other vertex " << g.VertexName(Top) << "\n";
+
+    using Clock = std::chrono::steady_clock;
+
+    auto Milliseconds = [](Clock::time_point Since)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - Since).count();
+    };
+
+    auto Start{ Clock::now() };
+
+    const TriangleResult Triangles{ g.ClusteringCoefficients() };
+
+    std::cout << "Triangles in R-MAT graph: " << Triangles.Triangles << ", average clustering coefficient "
+              << Triangles.AverageClustering << " (" << Milliseconds(Start) << " ms)\n";
+
+    Start = Clock::now();
+
+    const std::vector<VertexId> Cores{ g.CoreNumbers() };
+    const double SerialCoreMs{ Milliseconds(Start) };
+
+    Start = Clock::now();
+
+    const bool CoresAgree{ g.ParallelCoreNumbers() == Cores };
+
+    std::cout << "Degeneracy of R-MAT graph: " << *std::max_element(Cores.begin(), Cores.end()) << " (bucketed "
+              << SerialCoreMs << " ms, parallel peeling " << Milliseconds(Start) << " ms, "
+              << (CoresAgree ? "same" : "different") << " core numbers)\n";
+
+    Start = Clock::now();
+
+    BetweennessOptions Sampled;
+
+    Sampled.SampleCount = 256;
+
+    const std::vector<double> Centrality{ g.Betweenness(Sampled) };
+
+    Top = static_cast<VertexId>(std::max_element(Centrality.begin(), Centrality.end()) - Centrality.begin());
+
+    std::cout << "Betweenness of R-MAT graph from " << Sampled.SampleCount << " sampled sources: top vertex "
+              << g.VertexName(Top) << " (degree " << g.Out.Degree(Top) << ") in " << Milliseconds(Start) << " ms\n";
+
+    //
+    // Minimum spanning forest of a weighted R-MAT graph, with Kruskal and
+    // with Boruvka.
+    //
+
+    Graph Roads;
+
+    BuildRmatGraph(Roads, 16, 8, 100);
+
+    Start = Clock::now();
+
+    const SpanningForest Kruskal{ Roads.MinimumSpanningForest() };
+    const double KruskalMs{ Milliseconds(Start) };
+
+    Start = Clock::now();
+
+    const SpanningForest Boruvka{ Roads.ParallelMinimumSpanningForest() };
+
+    std::cout << "Minimum spanning forest of weighted R-MAT graph: " << Kruskal.Edges.size() << " edges, weight "
+              << Kruskal.TotalWeight << " (Kruskal " << KruskalMs << " ms, Boruvka " << Milliseconds(Start) << " ms, "
+              << ((Boruvka.Edges == Kruskal.Edges) ? "same" : "different") << " forest)\n";
+
+    //
+    // Strongly connected components of a directed R-MAT graph, with
+    // Tarjan and with the parallel algorithm.
+    //
+
+    Graph Dependencies;
+
+    BuildRmatGraph(Dependencies, 14, 8, 1, 27491095, false);
+
+    Start = Clock::now();
+
+    const SccResult Scc{ Dependencies.StronglyConnectedComponents() };
+
+    const double TarjanTime{ Milliseconds(Start) };
+
+    Start = Clock::now();
+
+    const SccResult ParallelScc{ Dependencies.ParallelStronglyConnectedComponents() };
+
+    std::vector<VertexId> Sizes(Scc.Count, 0);
+
+    for (VertexId Component : Scc.Component)
+    {
+        ++Sizes[Component];
+    }
+
+    std::cout << "Strongly connected components of a directed R-MAT graph: " << Scc.Count
+              << " (largest " << *std::max_element(Sizes.begin(), Sizes.end()) << "), condensation has "
+              << Scc.Condensation.EdgeCount() << " edges; Tarjan " << TarjanTime << " ms, parallel "
+              << Milliseconds(Start) << " ms" << (ParallelScc.Count == Scc.Count ? "" : " MISMATCH") << "\n";
+
+    //
+    // Reachability queries through the index, against bidirectional BFS.
+    //
+
+    Start = Clock::now();
+
+    ReachabilityIndex Reachability{ Dependencies.BuildReachabilityIndex() };
+
+    const double IndexTime{ Milliseconds(Start) };
+
+    std::mt19937 Sampler(27491095);
+    std::vector<Edge> Queries(1000000);
+
+    for (Edge& Query : Queries)
+    {
+        Query = Edge(static_cast<VertexId>(Sampler() % Dependencies.VertexCount()), static_cast<VertexId>(Sampler() % Dependencies.VertexCount()));
+    }
+
+    Start = Clock::now();
+
+    size_t Reachable{ 0 };
+
+    for (const Edge& Query : Queries)
+    {
+        Reachable += Reachability.Reaches(Query.first, Query.second);
+    }
+
+    const double IndexedNs{ Milliseconds(Start) * 1e6 / static_cast<double>(Queries.size()) };
+
+    Start = Clock::now();
+
+    size_t Agree{ 0 };
+
+    for (size_t q = 0; q < 1000; ++q)
+    {
+        const bool Found{ Dependencies.ShortestDistance(Dependencies.VertexName(Queries[q].first), Dependencies.VertexName(Queries[q].second)) >= 0 };
+
+        Agree += (Found == Reachability.Reaches(Queries[q].first, Queries[q].second));
+    }
+
+    std::cout << "Reachability index built in " << IndexTime << " ms: " << Reachable << " of " << Queries.size()
+              << " pairs reachable, " << IndexedNs << " ns per query against " << Milliseconds(Start) * 1e3 / 1000
+              << " us per BFS query (" << Agree << " of 1000 agree)\n";
+
+    //
+    // The 1000 distance queries above went through the cache; asking them
+    // again only costs lookups.
+    //
+
+    Start = Clock::now();
+
+    for (size_t q = 0; q < 1000; ++q)
+    {
+        Dependencies.ShortestDistance(Dependencies.VertexName(Queries[q].first), Dependencies.VertexName(Queries[q].second));
+    }
+
+    std::cout << "Repeated distance queries: " << Milliseconds(Start) * 1e3 / 1000 << " us per query from the cache\n";
+
+    //
+    // Serve the same queries from a frozen copy on every hardware thread at
+    // once, while the graph itself takes more edges and publishes a new
+    // copy that later queries pick up.
+    //
+
+    Dependencies.Publish();
+
+    const unsigned int Readers{ WorkerCount(0) };
+    std::atomic<size_t> Answered{ 0 };
+    std::vector<std::thread> Threads;
+
+    Start = Clock::now();
+
+    for (unsigned int t = 0; t < Readers; ++t)
+    {
+        Threads.emplace_back([&Dependencies, &Queries, &Answered, t, Readers]()
+        {
+            for (size_t q = t; q < 1000; q += Readers)
+            {
+                const std::shared_ptr<const FrozenGraph> Frozen{ Dependencies.Current() };
+
+                Frozen->ShortestDistance(Frozen->VertexName(Queries[q].first), Frozen->VertexName(Queries[q].second));
+                Answered.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    Dependencies.AddDirectedEdge("0", "1");
+    Dependencies.Publish();
+
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+
+    std::cout << "Concurrent distance queries on frozen copies: " << Answered.load() << " on " << Readers
+              << " threads in " << Milliseconds(Start) << " ms\n";
+
+    //
+    // Copy the R-MAT adjacency into a dynamic store, check that it scans
+    // about as fast as the CSR, then stream batches of edge insertions and
+    // deletions into it and traverse it again, without any rebuild.
+    //
+
+    DynamicAdjacency Dynamic;
+
+    Dynamic.Build(g.Out);
+
+    Start = Clock::now();
+
+    Bfs = DirectionOptimizingBfs(g.Out, g.Out, 0);
+
+    const double CsrTime{ Milliseconds(Start) };
+
+    Start = Clock::now();
+
+    Bfs = DirectionOptimizingBfs(Dynamic, Dynamic, 0);
+
+    std::cout << "BFS over R-MAT graph: " << CsrTime << " ms on the CSR, " << Milliseconds(Start) << " ms on the dynamic store\n";
+
+    std::mt19937 Random(27491095);
+    std::uniform_int_distribution<VertexId> Pick(0, g.VertexCount() - 1);
+
+    std::vector<Edge> Insertions;
+    std::vector<Edge> Deletions;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        const VertexId From{ Pick(Random) };
+        const VertexId To{ Pick(Random) };
+
+        Insertions.push_back(Edge(From, To));
+        Insertions.push_back(Edge(To, From));
+    }
+
+    for (size_t e = 0; e < g.Edges.size(); e += 8)
+    {
+        Deletions.push_back(g.Edges[e]);
+        Deletions.push_back(Edge(g.Edges[e].second, g.Edges[e].first));
+    }
+
+    Start = Clock::now();
+
+    const EdgeIndex Inserted{ Dynamic.InsertEdges(Insertions) };
+    const EdgeIndex Deleted{ Dynamic.DeleteEdges(Deletions) };
+
+    std::cout << "Dynamic store: inserted " << Inserted << " and deleted " << Deleted << " edges in " << Milliseconds(Start) << " ms\n";
+
+    Bfs = ParallelBfs(Dynamic, 0);
+    Components = ParallelComponents(Dynamic, nullptr);
+
+    std::cout << "Parallel BFS over the updated graph: reached " << Bfs.Reached << " of " << Dynamic.VertexCount()
+              << " vertices; " << Components.Count << " components\n";
+
+    //
+    // The same traversals straight off a compressed copy of the adjacency.
+    //
+
+    CompressedAdjacency Compressed;
+
+    Compressed.Build(g.Out);
+
+    Start = Clock::now();
+
+    Bfs = DirectionOptimizingBfs(Compressed, Compressed, 0);
+
+    const double CompressedTime{ Milliseconds(Start) };
+
+    Components = ParallelComponents(Compressed, nullptr);
+
+    std::cout << "Compressed adjacency: " << Compressed.MemoryBytes() << " bytes instead of "
+              << g.Out.Offsets.size() * sizeof(EdgeIndex) + g.Out.Targets.size() * sizeof(VertexId)
+              << "; BFS reached " << Bfs.Reached << " vertices in " << CompressedTime << " ms; "
+              << Components.Count << " components\n";
+
+    //
+    // Encoding straight from the sorted edge list gives the same bytes.
+    //
+
+    std::vector<Edge> SortedEdges(g.Edges);
+
+    ParallelSort(SortedEdges.begin(), SortedEdges.end(), std::less<Edge>());
+
+    CompressedAdjacency Streamed;
+
+    Streamed.Build(g.VertexCount(), SortedEdges);
+
+    std::cout << "Compressed adjacency from the sorted edge list: "
+              << ((Streamed.Bytes == Compressed.Bytes) && (Streamed.Offsets == Compressed.Offsets) && (Streamed.Edges == Compressed.Edges) ? "identical" : "DIFFERENT") << "\n";
+
+    //
+    // Round trip the R-MAT graph through a text edge list and a binary
+    // snapshot.
+    //
+
+    const std::filesystem::path EdgeListPath{ std::filesystem::temp_directory_path() / "rmat.edges" };
+    const std::filesystem::path SnapshotPath{ std::filesystem::temp_directory_path() / "rmat.graph" };
+
+    {
+        std::ofstream EdgeList(EdgeListPath);
+
+        for (const Edge& edge : g.Edges)
+        {
+            if (edge.first < edge.second)
+            {
+                EdgeList << g.VertexName(edge.first) << " " << g.VertexName(edge.second) << "\n";
+            }
+        }
+    }
+
+    Graph Loaded;
+
+    Start = Clock::now();
+
+    if (Loaded.LoadEdgeList(EdgeListPath.string().c_str()))
+    {
+        std::cout << "Loaded edge list: " << Loaded.VertexCount() << " vertices, " << Loaded.Out.EdgeCount() << " edges in "
+                  << Milliseconds(Start) << " ms\n";
+    }
+
+    Loaded.SaveSnapshot(SnapshotPath.string().c_str());
+
+    Start = Clock::now();
+
+    if (Loaded.LoadSnapshot(SnapshotPath.string().c_str()))
+    {
+        std::cout << "Loaded snapshot: " << Loaded.VertexCount() << " vertices, " << Loaded.Out.EdgeCount() << " edges in "
+                  << Milliseconds(Start) << " ms\n";
+    }
+
+    //
+    // A header claiming 2^62 edges, in a file that is all header, has to be
+    // rejected rather than wrap the offsets around and try to allocate them.
+    //
+
+    {
+        SnapshotHeader Crafted{};
+
+        memcpy(Crafted.Magic, SnapshotHeader::ExpectedMagic, sizeof(Crafted.Magic));
+        Crafted.Version = SnapshotHeader::CurrentVersion;
+        Crafted.EdgeCount = 1ull << 62;
+
+        std::ofstream(SnapshotPath, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(&Crafted), sizeof(Crafted));
+    }
+
+    std::cout << "Crafted snapshot header: " << (Loaded.LoadSnapshot(SnapshotPath.string().c_str()) ? "LOADED" : "rejected") << "\n";
+
+    //
+    // Same for a snapshot whose only neighbor list is out of order: a -> c
+    // swapped ahead of a -> b.
+    //
+
+    {
+        Graph Unsorted;
+
+        Unsorted.AddDirectedEdge("a", "b");
+        Unsorted.AddDirectedEdge("a", "c");
+        Unsorted.SaveSnapshot(SnapshotPath.string().c_str());
+
+        std::fstream File(SnapshotPath, std::ios::binary | std::ios::in | std::ios::out);
+
+        const std::streamoff TargetsAt{ static_cast<std::streamoff>(sizeof(SnapshotHeader) + (Unsorted.VertexCount() + 1) * sizeof(EdgeIndex)) };
+
+        VertexId Targets[2];
+
+        File.seekg(TargetsAt);
+        File.read(reinterpret_cast<char*>(Targets), sizeof(Targets));
+
+        std::swap(Targets[0], Targets[1]);
+
+        File.seekp(TargetsAt);
+        File.write(reinterpret_cast<const char*>(Targets), sizeof(Targets));
+    }
+
+    std::cout << "Snapshot with an unsorted neighbor list: " << (Loaded.LoadSnapshot(SnapshotPath.string().c_str()) ? "LOADED" : "rejected") << "\n";
+
+    std::filesystem::remove(EdgeListPath);
+    std::filesystem::remove(SnapshotPath);
 
     return (0);
 }